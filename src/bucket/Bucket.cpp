@@ -8,8 +8,10 @@
 #include "util/asio.h"
 #include "bucket/Bucket.h"
 #include "bucket/BucketApplicator.h"
+#include "bucket/BucketIndex.h"
 #include "bucket/BucketList.h"
 #include "bucket/BucketManager.h"
+#include "bucket/BucketMergeIterator.h"
 #include "bucket/BucketOutputIterator.h"
 #include "bucket/LedgerCmp.h"
 #include "crypto/Hex.h"
@@ -31,6 +33,7 @@
 #include "util/XDRStream.h"
 #include "util/make_unique.h"
 #include "xdrpp/message.h"
+#include <algorithm>
 #include <cassert>
 #include <future>
 
@@ -48,10 +51,25 @@ Bucket::Bucket(std::string const& filename, Hash const& hash)
     }
 }
 
+Bucket::Bucket(std::vector<BucketEntry>&& entries,
+               std::unique_ptr<BucketIndex const> index, Hash const& hash)
+    : mHash(hash)
+    , mIndex(std::move(index))
+    , mEntries(make_unique<std::vector<BucketEntry> const>(std::move(entries)))
+{
+    assert(mIndex);
+    CLOG(TRACE, "Bucket") << "Bucket::Bucket() created in memory, "
+                          << mEntries->size() << " entries";
+}
+
 Bucket::Bucket()
 {
 }
 
+Bucket::~Bucket()
+{
+}
+
 Hash const&
 Bucket::getHash() const
 {
@@ -64,20 +82,97 @@ Bucket::getFilename() const
     return mFilename;
 }
 
+bool
+Bucket::isInMemory() const
+{
+    return static_cast<bool>(mEntries);
+}
+
+std::vector<BucketEntry> const&
+Bucket::getInMemoryEntries() const
+{
+    assert(mEntries);
+    return *mEntries;
+}
+
+BucketIndex const&
+Bucket::getIndex() const
+{
+    std::lock_guard<std::mutex> lock(mIndexMutex);
+    if (!mIndex)
+    {
+        if (mFilename.empty())
+        {
+            auto index = make_unique<BucketIndex>();
+            index->finish();
+            mIndex = std::move(index);
+        }
+        else
+        {
+            mIndex = BucketIndex::loadOrBuild(mFilename);
+        }
+    }
+    return *mIndex;
+}
+
 bool
 Bucket::containsBucketIdentity(BucketEntry const& id) const
 {
-    BucketEntryIdCmp cmp;
-    BucketInputIterator iter(shared_from_this());
-    while (iter)
+    return static_cast<bool>(getEntry(getBucketEntryKey(id)));
+}
+
+optional<BucketEntry>
+Bucket::getEntry(LedgerKey const& key) const
+{
+    if (mEntries)
     {
-        if (!(cmp(*iter, id) || cmp(id, *iter)))
+        LedgerEntryIdCmp cmp;
+        auto i = std::lower_bound(mEntries->begin(), mEntries->end(), key,
+                                  [&cmp](BucketEntry const& e,
+                                         LedgerKey const& k) {
+                                      return cmp(getBucketEntryKey(e), k);
+                                  });
+        if (i != mEntries->end() && !cmp(key, getBucketEntryKey(*i)))
         {
-            return true;
+            return make_optional<BucketEntry>(*i);
         }
-        ++iter;
+        return nullopt<BucketEntry>();
     }
-    return false;
+
+    if (mFilename.empty())
+    {
+        return nullopt<BucketEntry>();
+    }
+
+    auto const& index = getIndex();
+    size_t offset;
+    if (!index.mayContain(BucketIndex::keyHash(key)) ||
+        !index.lookup(key, offset))
+    {
+        return nullopt<BucketEntry>();
+    }
+
+    // Scan forward from the start of the candidate page until we reach or
+    // pass the key; entries are sorted, so this never leaves the page.
+    LedgerEntryIdCmp cmp;
+    XDRInputFileStream in;
+    in.open(mFilename);
+    in.seek(offset);
+    BucketEntry e;
+    while (in.readOne(e))
+    {
+        auto k = getBucketEntryKey(e);
+        if (cmp(k, key))
+        {
+            continue;
+        }
+        if (cmp(key, k))
+        {
+            break;
+        }
+        return make_optional<BucketEntry>(e);
+    }
+    return nullopt<BucketEntry>();
 }
 
 std::pair<size_t, size_t>
@@ -113,9 +208,9 @@ Bucket::apply(Database& db) const
 std::shared_ptr<Bucket>
 Bucket::fresh(BucketManager& bucketManager,
               std::vector<LedgerEntry> const& liveEntries,
-              std::vector<LedgerKey> const& deadEntries)
+              std::vector<LedgerKey> const& deadEntries, bool inMemory)
 {
-    std::vector<BucketEntry> live, dead, combined;
+    std::vector<BucketEntry> live, dead;
     live.reserve(liveEntries.size());
     dead.reserve(deadEntries.size());
 
@@ -135,33 +230,60 @@ Bucket::fresh(BucketManager& bucketManager,
         dead.push_back(ce);
     }
 
-    std::sort(live.begin(), live.end(), BucketEntryIdCmp());
-
-    std::sort(dead.begin(), dead.end(), BucketEntryIdCmp());
-
-    BucketOutputIterator liveOut(bucketManager.getTmpDir(), true);
-    BucketOutputIterator deadOut(bucketManager.getTmpDir(), true);
-    for (auto const& e : live)
-    {
-        liveOut.put(e);
-    }
-    for (auto const& e : dead)
+    // Live entries go first, so that a stable sort leaves any dead entry
+    // after a live entry with the same key, and the dead entry wins in the
+    // output iterator; this matches merging a live-only bucket with a newer
+    // dead-only one, in a single pass and without intermediate buckets.
+    std::vector<BucketEntry> combined;
+    combined.reserve(live.size() + dead.size());
+    combined.insert(combined.end(), std::make_move_iterator(live.begin()),
+                    std::make_move_iterator(live.end()));
+    combined.insert(combined.end(), std::make_move_iterator(dead.begin()),
+                    std::make_move_iterator(dead.end()));
+    std::stable_sort(combined.begin(), combined.end(), BucketEntryIdCmp());
+
+    BucketOutputIterator out(bucketManager.getTmpDir(), true, inMemory);
+    for (auto const& e : combined)
     {
-        deadOut.put(e);
+        out.put(e);
     }
-
-    auto liveBucket = liveOut.getBucket(bucketManager);
-    auto deadBucket = deadOut.getBucket(bucketManager);
-    return Bucket::merge(bucketManager, liveBucket, deadBucket);
+    return out.getBucket(bucketManager);
 }
 
+// Counts of bloom filter outcomes over a single merge, reported to the
+// BucketManager's meters once the merge is done.
+struct ShadowFilterStats
+{
+    uint64_t mLookups{0};
+    uint64_t mNegatives{0};
+    uint64_t mFalsePositives{0};
+};
+
 inline void
 maybePut(BucketOutputIterator& out, BucketEntry const& entry,
-         std::vector<BucketInputIterator>& shadowIterators)
+         std::vector<BucketInputIterator>& shadowIterators,
+         std::vector<BucketIndex const*> const& shadowIndexes,
+         ShadowFilterStats& stats)
 {
     BucketEntryIdCmp cmp;
-    for (auto& si : shadowIterators)
+    uint64_t keyHash = 0;
+    if (!shadowIterators.empty())
+    {
+        keyHash = BucketIndex::keyHash(getBucketEntryKey(entry));
+    }
+    for (size_t i = 0; i < shadowIterators.size(); ++i)
     {
+        // If the shadow's bloom filter rules the entry out, skip both reading
+        // and comparing; the shadow iterator will catch up later, if and when
+        // a later entry might be in it.
+        ++stats.mLookups;
+        if (!shadowIndexes[i]->mayContain(keyHash))
+        {
+            ++stats.mNegatives;
+            continue;
+        }
+
+        auto& si = shadowIterators[i];
         // Advance the shadowIterator while it's less than the candidate
         while (si && cmp(*si, entry))
         {
@@ -178,6 +300,7 @@ maybePut(BucketOutputIterator& out, BucketEntry const& entry,
             // necessary in future calls to maybePut.
             return;
         }
+        ++stats.mFalsePositives;
     }
     // Nothing shadowed.
     out.put(entry);
@@ -188,7 +311,7 @@ Bucket::merge(BucketManager& bucketManager,
               std::shared_ptr<Bucket> const& oldBucket,
               std::shared_ptr<Bucket> const& newBucket,
               std::vector<std::shared_ptr<Bucket>> const& shadows,
-              bool keepDeadEntries)
+              bool keepDeadEntries, bool inMemory)
 {
     // This is the key operation in the scheme: merging two (read-only)
     // buckets together into a new 3rd bucket, while calculating its hash,
@@ -202,9 +325,16 @@ Bucket::merge(BucketManager& bucketManager,
 
     std::vector<BucketInputIterator> shadowIterators(shadows.begin(),
                                                      shadows.end());
+    std::vector<BucketIndex const*> shadowIndexes;
+    for (auto const& s : shadows)
+    {
+        shadowIndexes.emplace_back(&s->getIndex());
+    }
+    ShadowFilterStats stats;
 
     auto timer = bucketManager.getMergeTimer().TimeScope();
-    BucketOutputIterator out(bucketManager.getTmpDir(), keepDeadEntries);
+    BucketOutputIterator out(bucketManager.getTmpDir(), keepDeadEntries,
+                             inMemory);
 
     BucketEntryIdCmp cmp;
     while (oi || ni)
@@ -212,35 +342,38 @@ Bucket::merge(BucketManager& bucketManager,
         if (!ni)
         {
             // Out of new entries, take old entries.
-            maybePut(out, *oi, shadowIterators);
+            maybePut(out, *oi, shadowIterators, shadowIndexes, stats);
             ++oi;
         }
         else if (!oi)
         {
             // Out of old entries, take new entries.
-            maybePut(out, *ni, shadowIterators);
+            maybePut(out, *ni, shadowIterators, shadowIndexes, stats);
             ++ni;
         }
         else if (cmp(*oi, *ni))
         {
             // Next old-entry has smaller key, take it.
-            maybePut(out, *oi, shadowIterators);
+            maybePut(out, *oi, shadowIterators, shadowIndexes, stats);
             ++oi;
         }
         else if (cmp(*ni, *oi))
         {
             // Next new-entry has smaller key, take it.
-            maybePut(out, *ni, shadowIterators);
+            maybePut(out, *ni, shadowIterators, shadowIndexes, stats);
             ++ni;
         }
         else
         {
             // Old and new are for the same key, take new.
-            maybePut(out, *ni, shadowIterators);
+            maybePut(out, *ni, shadowIterators, shadowIndexes, stats);
             ++oi;
             ++ni;
         }
     }
+    bucketManager.getBloomLookupMeter().Mark(stats.mLookups);
+    bucketManager.getBloomNegativeMeter().Mark(stats.mNegatives);
+    bucketManager.getBloomFalsePositiveMeter().Mark(stats.mFalsePositives);
     return out.getBucket(bucketManager);
 }
 
@@ -270,7 +403,7 @@ checkDBAgainstBuckets(medida::MetricsRegistry& metrics,
     auto execTimer =
         metrics.NewTimer({"bucket", "checkdb", "execute"}).TimeScope();
 
-    // Step 1: Collect all buckets to merge.
+    // Step 1: Collect all buckets to scan, newest first.
     std::vector<std::shared_ptr<Bucket>> buckets;
     for (uint32_t i = 0; i < BucketList::kNumLevels; ++i)
     {
@@ -293,31 +426,17 @@ checkDBAgainstBuckets(medida::MetricsRegistry& metrics,
         return;
     }
 
-    // Step 2: merge all buckets into a single super-bucket.
-    auto i = buckets.begin();
-    assert(i != buckets.end());
-    std::shared_ptr<Bucket> superBucket = *i;
-    while (++i != buckets.end())
-    {
-        auto mergeTimer =
-            metrics.NewTimer({"bucket", "checkdb", "merge"}).TimeScope();
-        assert(superBucket);
-        assert(*i);
-        superBucket = Bucket::merge(bucketManager, *i, superBucket);
-        assert(superBucket);
-    }
-
     CLOG(INFO, "Bucket") << "CheckDB starting object comparison";
 
-    // Step 3: scan the superbucket, checking each object against the DB and
-    // counting objects along the way.
+    // Step 2: scan the logical union of all buckets in a single k-way merge,
+    // checking each object against the DB and counting objects along the way.
     uint64_t nAccounts = 0, nTrustLines = 0, nOffers = 0, nData = 0;
     {
         auto& meter = metrics.NewMeter({"bucket", "checkdb", "object-compare"},
                                        "comparison");
         auto compareTimer =
             metrics.NewTimer({"bucket", "checkdb", "compare"}).TimeScope();
-        for (BucketInputIterator iter(superBucket); iter; ++iter)
+        for (BucketMergeIterator iter(buckets); iter; ++iter)
         {
             meter.Mark();
             auto& e = *iter;
@@ -352,7 +471,7 @@ checkDBAgainstBuckets(medida::MetricsRegistry& metrics,
         }
     }
 
-    // Step 4: confirm size of datasets matches size of datasets in DB.
+    // Step 3: confirm size of datasets matches size of datasets in DB.
     soci::session& sess = db.getSession();
     compareSizes("account", AccountFrame::countObjects(sess), nAccounts);
     compareSizes("trustline", TrustFrame::countObjects(sess), nTrustLines);
@@ -9,6 +9,8 @@
 #include "overlay/StellarXDR.h"
 #include "util/NonCopyable.h"
 #include "util/XDRStream.h"
+#include "util/optional.h"
+#include <mutex>
 #include <string>
 
 namespace medida
@@ -30,6 +32,7 @@ namespace stellar
  * merged in sorted order, and all elements are hashed while being added.
  */
 
+class BucketIndex;
 class BucketManager;
 class BucketList;
 class Database;
@@ -41,6 +44,16 @@ class Bucket : public std::enable_shared_from_this<Bucket>,
     std::string const mFilename;
     Hash const mHash;
 
+    // The page index is loaded (or rebuilt) lazily on first lookup. It is
+    // derived entirely from the immutable file, so caching it does not
+    // compromise the bucket's immutability.
+    mutable std::mutex mIndexMutex;
+    mutable std::unique_ptr<BucketIndex const> mIndex;
+
+    // Set only for in-memory buckets, which have no file: the bucket's
+    // entries, in bucket order.
+    std::unique_ptr<std::vector<BucketEntry> const> const mEntries;
+
   public:
     // Create an empty bucket. The empty bucket has hash '000000...' and its
     // filename is the empty string.
@@ -51,13 +64,35 @@ class Bucket : public std::enable_shared_from_this<Bucket>,
     // needs to ensure that.
     Bucket(std::string const& filename, Hash const& hash);
 
+    // Construct an in-memory bucket holding `entries`, with the index and hash
+    // its file form would have. Such a bucket has an empty filename until the
+    // BucketManager writes it out (as a separate, file-backed Bucket).
+    Bucket(std::vector<BucketEntry>&& entries,
+           std::unique_ptr<BucketIndex const> index, Hash const& hash);
+
+    ~Bucket();
+
     Hash const& getHash() const;
     std::string const& getFilename() const;
 
+    bool isInMemory() const;
+
+    // Precondition: isInMemory(); return the bucket's entries.
+    std::vector<BucketEntry> const& getInMemoryEntries() const;
+
+    // Return the bucket's page index and bloom filter, loading or building it
+    // on first use.
+    BucketIndex const& getIndex() const;
+
     // Returns true if a BucketEntry that is key-wise identical to the given
     // BucketEntry exists in the bucket. For testing.
     bool containsBucketIdentity(BucketEntry const& id) const;
 
+    // Returns the (live or dead) BucketEntry for `key` if the bucket holds
+    // one, using the bucket's page index to read at most one page of the
+    // bucket file.
+    optional<BucketEntry> getEntry(LedgerKey const& key) const;
+
     // Return the count of live and dead BucketEntries in the bucket. For
     // testing.
     std::pair<size_t, size_t> countLiveAndDeadEntries() const;
@@ -70,23 +105,26 @@ class Bucket : public std::enable_shared_from_this<Bucket>,
 
     // Create a fresh bucket from a given vector of live LedgerEntries and
     // dead LedgerEntryKeys. The bucket will be sorted, hashed, and adopted
-    // in the provided BucketManager.
+    // in the provided BucketManager; if `inMemory`, it is kept in memory
+    // rather than written to a file.
     static std::shared_ptr<Bucket>
     fresh(BucketManager& bucketManager,
           std::vector<LedgerEntry> const& liveEntries,
-          std::vector<LedgerKey> const& deadEntries);
+          std::vector<LedgerKey> const& deadEntries, bool inMemory = false);
 
     // Merge two buckets together, producing a fresh one. Entries in `oldBucket`
     // are overridden in the fresh bucket by keywise-equal entries in
     // `newBucket`. Entries are inhibited from the fresh bucket by keywise-equal
-    // entries in any of the buckets in the provided `shadows` vector.
+    // entries in any of the buckets in the provided `shadows` vector. If
+    // `inMemory`, the fresh bucket is kept in memory rather than written to a
+    // file.
     static std::shared_ptr<Bucket>
     merge(BucketManager& bucketManager,
           std::shared_ptr<Bucket> const& oldBucket,
           std::shared_ptr<Bucket> const& newBucket,
           std::vector<std::shared_ptr<Bucket>> const& shadows =
               std::vector<std::shared_ptr<Bucket>>(),
-          bool keepDeadEntries = true);
+          bool keepDeadEntries = true, bool inMemory = false);
 };
 
 void checkDBAgainstBuckets(medida::MetricsRegistry& metrics,
@@ -5,18 +5,59 @@
 #include "util/asio.h"
 #include "bucket/BucketApplicator.h"
 #include "bucket/Bucket.h"
-#include "ledger/LedgerDelta.h"
+#include "database/BulkTableWriter.h"
+#include "database/Database.h"
+#include "ledger/AccountFrame.h"
+#include "ledger/DataFrame.h"
+#include "ledger/EntryFrame.h"
+#include "ledger/OfferFrame.h"
+#include "ledger/TrustFrame.h"
+#include "main/Application.h"
+#include "main/Config.h"
+#include "util/ClaimableTask.h"
 #include "util/Logging.h"
 
 namespace stellar
 {
 
+// Number of bucket entries written (and committed) per call to advance().
+static size_t const kBatchSize = 0x1000;
+
 BucketApplicator::BucketApplicator(Database& db,
                                    std::shared_ptr<const Bucket> bucket)
-    : mDb(db), mBucketIter(bucket)
+    : mDb(db)
+    , mBucketIter(bucket)
+    , mAccounts(AccountFrame::makeBulkWriter(db))
+    , mSigners(AccountFrame::makeBulkSignersWriter(db))
+    , mTrustLines(TrustFrame::makeBulkWriter(db))
+    , mOffers(OfferFrame::makeBulkWriter(db))
+    , mData(DataFrame::makeBulkWriter(db))
+{
+}
+
+BucketApplicator::BucketApplicator(Application& app,
+                                   std::shared_ptr<const Bucket> bucket)
+    : BucketApplicator(app.getDatabase(), bucket)
+{
+    if (canApplyInParallel(app))
+    {
+        mApp = &app;
+    }
+}
+
+BucketApplicator::~BucketApplicator()
 {
 }
 
+bool
+BucketApplicator::canApplyInParallel(Application& app)
+{
+    // SQLite serializes writers, so there is nothing to gain there.
+    auto& db = app.getDatabase();
+    return app.getConfig().PARALLEL_BUCKET_APPLY && !db.isSqlite() &&
+           db.canUsePool();
+}
+
 BucketApplicator::operator bool() const
 {
     return (bool)mBucketIter;
@@ -25,36 +66,167 @@ BucketApplicator::operator bool() const
 void
 BucketApplicator::advance()
 {
-    soci::transaction sqlTx(mDb.getSession());
-    for (; mBucketIter; ++mBucketIter)
+    size_t n = 0;
+    for (; mBucketIter && n < kBatchSize; ++mBucketIter, ++n)
     {
-        LedgerHeader lh;
-        LedgerDelta delta(lh, mDb, false);
-
         auto const& entry = *mBucketIter;
         if (entry.type() == LIVEENTRY)
         {
-            EntryFrame::pointer ep = EntryFrame::FromXDR(entry.liveEntry());
-            ep->storeAddOrChange(delta, mDb);
+            auto const& e = entry.liveEntry();
+            EntryFrame::flushCachedEntry(LedgerEntryKey(e), mDb);
+            switch (e.data.type())
+            {
+            case ACCOUNT:
+                AccountFrame::bulkUpsert(*mAccounts, *mSigners, e);
+                break;
+            case TRUSTLINE:
+                TrustFrame::bulkUpsert(*mTrustLines, e);
+                break;
+            case OFFER:
+                OfferFrame::bulkUpsert(*mOffers, e);
+                break;
+            case DATA:
+                DataFrame::bulkUpsert(*mData, e);
+                break;
+            }
         }
         else
         {
-            EntryFrame::storeDelete(delta, mDb, entry.deadEntry());
+            auto const& k = entry.deadEntry();
+            EntryFrame::flushCachedEntry(k, mDb);
+            switch (k.type())
+            {
+            case ACCOUNT:
+                AccountFrame::bulkErase(*mAccounts, *mSigners, k);
+                break;
+            case TRUSTLINE:
+                TrustFrame::bulkErase(*mTrustLines, k);
+                break;
+            case OFFER:
+                OfferFrame::bulkErase(*mOffers, k);
+                break;
+            case DATA:
+                DataFrame::bulkErase(*mData, k);
+                break;
+            }
+        }
+    }
+
+    if (mApp)
+    {
+        flushParallel();
+    }
+    else
+    {
+        flushSequential();
+    }
+    mDb.getOrderBook().clear();
+    mSize += n;
+
+    CLOG(INFO, "Bucket") << "Bucket-apply: committed " << mSize << " entries";
+}
+
+void
+BucketApplicator::flushSequential()
+{
+    soci::transaction sqlTx(mDb.getSession());
+    mAccounts->flush();
+    mSigners->flush();
+    mTrustLines->flush();
+    mOffers->flush();
+    mData->flush();
+    sqlTx.commit();
+}
+
+void
+BucketApplicator::flushParallel()
+{
+    // Each partition commits on its own; if one fails, the others may already
+    // have committed. That's fine: the whole bucket is applied again on
+    // retry, and every write is an idempotent upsert or delete.
+    std::vector<std::vector<BulkTableWriter*>> partitions = {
+        {mAccounts.get(), mSigners.get()},
+        {mTrustLines.get()},
+        {mOffers.get()},
+        {mData.get()}};
+    std::vector<std::shared_ptr<ClaimableTask>> tasks;
+    auto& pool = mDb.getPool();
+    for (auto const& writers : partitions)
+    {
+        bool empty = true;
+        for (auto w : writers)
+        {
+            empty = empty && w->size() == 0;
         }
-        // No-op, just to avoid needless rollback.
-        delta.commit();
-        if ((++mSize & 0xff) == 0xff)
+        if (empty)
         {
-            break;
+            continue;
         }
+        auto task = std::make_shared<ClaimableTask>([writers, &pool]() {
+            soci::session sess(pool);
+            soci::transaction sqlTx(sess);
+            for (auto w : writers)
+            {
+                w->flush(sess);
+            }
+            sqlTx.commit();
+        });
+        tasks.emplace_back(task);
+        mApp->getWorkerIOService().post([task]() { task->run(); });
     }
-    sqlTx.commit();
-    mDb.clearPreparedStatementCache();
 
-    if (!mBucketIter || (mSize & 0xfff) == 0xfff)
+    // The worker threads may be busy with bucket merges; this thread flushes
+    // any partition none of them has started yet.
+    for (auto const& t : tasks)
     {
-        CLOG(INFO, "Bucket")
-            << "Bucket-apply: committed " << mSize << " entries";
+        t->run();
     }
+
+    // Wait for all partitions before reporting the first failure, so that no
+    // worker is still using a writer when this applicator is destroyed.
+    std::exception_ptr failure;
+    for (auto const& t : tasks)
+    {
+        try
+        {
+            t->wait();
+        }
+        catch (...)
+        {
+            if (!failure)
+            {
+                failure = std::current_exception();
+            }
+        }
+    }
+    if (failure)
+    {
+        std::rethrow_exception(failure);
+    }
+}
+
+bool
+BucketApplicator::dropIndexesIfEmpty(Database& db)
+{
+    auto& sess = db.getSession();
+    if (AccountFrame::countObjects(sess) != 0 ||
+        TrustFrame::countObjects(sess) != 0 ||
+        OfferFrame::countObjects(sess) != 0 ||
+        DataFrame::countObjects(sess) != 0)
+    {
+        return false;
+    }
+    CLOG(INFO, "Bucket") << "Bucket-apply: dropping secondary indexes";
+    AccountFrame::dropSecondaryIndexes(db);
+    OfferFrame::dropSecondaryIndexes(db);
+    return true;
+}
+
+void
+BucketApplicator::rebuildIndexes(Database& db)
+{
+    CLOG(INFO, "Bucket") << "Bucket-apply: rebuilding secondary indexes";
+    AccountFrame::createSecondaryIndexes(db);
+    OfferFrame::createSecondaryIndexes(db);
 }
 }
@@ -13,21 +13,55 @@
 namespace stellar
 {
 
+class Application;
+class BulkTableWriter;
 class Database;
 
 // Class that represents a single apply-bucket-to-database operation in
 // progress. Used during history catchup to split up the task of applying
 // bucket into scheduler-friendly, bite-sized pieces.
+//
+// Entries are grouped by type and written a batch at a time, with one
+// BulkTableWriter per table, rather than one statement per row. Entries of
+// different types land in disjoint tables, so in parallel mode each type's
+// rows are written over its own pooled connection, by a worker thread or by
+// the applying thread if no worker got to them first.
 
 class BucketApplicator
 {
     Database& mDb;
     BucketInputIterator mBucketIter;
     size_t mSize{0};
+    Application* mApp{nullptr};
+
+    std::unique_ptr<BulkTableWriter> mAccounts;
+    std::unique_ptr<BulkTableWriter> mSigners;
+    std::unique_ptr<BulkTableWriter> mTrustLines;
+    std::unique_ptr<BulkTableWriter> mOffers;
+    std::unique_ptr<BulkTableWriter> mData;
+
+    void flushSequential();
+    void flushParallel();
 
   public:
     BucketApplicator(Database& db, std::shared_ptr<const Bucket> bucket);
+
+    // Apply in parallel if the app is configured to (PARALLEL_BUCKET_APPLY)
+    // and its database supports it, otherwise sequentially.
+    BucketApplicator(Application& app, std::shared_ptr<const Bucket> bucket);
+
+    ~BucketApplicator();
+
+    // Returns true if buckets can be applied in parallel to `app`'s database.
+    static bool canApplyInParallel(Application& app);
+
     operator bool() const;
     void advance();
+
+    // Secondary indexes on the ledger-entry tables only slow down a bulk
+    // load. If all those tables are empty, drop the indexes and return true;
+    // the caller must then call `rebuildIndexes` once it's done applying.
+    static bool dropIndexesIfEmpty(Database& db);
+    static void rebuildIndexes(Database& db);
 };
 }
@@ -0,0 +1,181 @@
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "bucket/BucketIndex.h"
+#include "bucket/LedgerCmp.h"
+#include "crypto/ShortHash.h"
+#include "ledger/EntryFrame.h"
+#include "util/Fs.h"
+#include "util/Logging.h"
+#include "util/XDRStream.h"
+#include "util/make_unique.h"
+#include <algorithm>
+
+namespace stellar
+{
+
+size_t const BucketIndex::kPageSize = 16384;
+
+// Bump this whenever the on-disk layout of index files changes; index files
+// with any other version are ignored and rebuilt.
+static uint32_t const kIndexFormatVersion = 2;
+
+LedgerKey
+getBucketEntryKey(BucketEntry const& e)
+{
+    if (e.type() == LIVEENTRY)
+    {
+        return LedgerEntryKey(e.liveEntry());
+    }
+    return e.deadEntry();
+}
+
+std::string
+BucketIndex::indexFilename(std::string const& bucketFilename)
+{
+    return bucketFilename + ".index";
+}
+
+uint64_t
+BucketIndex::keyHash(LedgerKey const& k)
+{
+    return shortHash(xdr::xdr_to_opaque(k));
+}
+
+void
+BucketIndex::add(BucketEntry const& e, size_t offset)
+{
+    auto k = getBucketEntryKey(e);
+    mKeyHashes.emplace_back(keyHash(k));
+    if (offset >= mNextPageOffset)
+    {
+        mPages.emplace_back(Page{std::move(k), offset});
+        mNextPageOffset = offset + kPageSize;
+    }
+}
+
+void
+BucketIndex::finish()
+{
+    mBloom = BloomFilter(mKeyHashes.size());
+    for (auto h : mKeyHashes)
+    {
+        mBloom.add(h);
+    }
+    std::vector<uint64_t>().swap(mKeyHashes);
+}
+
+bool
+BucketIndex::save(std::string const& filename) const
+{
+    // The index file is a version header, the bloom filter's probe count and
+    // bits, then one (LedgerKey, offset) pair of XDR records per page.
+    XDROutputFileStream out;
+    out.open(filename);
+    bool ok = out.writeOne(kIndexFormatVersion) &&
+              out.writeOne(mBloom.getNumHashes()) &&
+              out.writeOne(mBloom.getBits());
+    for (auto const& p : mPages)
+    {
+        if (!ok)
+        {
+            break;
+        }
+        uint64_t offset = p.mOffset;
+        ok = out.writeOne(p.mFirstKey) && out.writeOne(offset);
+    }
+    out.close();
+    if (!ok)
+    {
+        std::remove(filename.c_str());
+    }
+    return ok;
+}
+
+std::unique_ptr<BucketIndex>
+BucketIndex::loadOrBuild(std::string const& bucketFilename)
+{
+    auto index = make_unique<BucketIndex>();
+    auto filename = indexFilename(bucketFilename);
+
+    if (fs::exists(filename))
+    {
+        XDRInputFileStream in;
+        in.open(filename);
+        uint32_t version = 0;
+        bool valid = false;
+        try
+        {
+            uint32_t numHashes = 0;
+            xdr::xvector<uint64_t> bits;
+            if (in.readOne(version) && version == kIndexFormatVersion &&
+                in.readOne(numHashes) && in.readOne(bits))
+            {
+                index->mBloom = BloomFilter(numHashes, std::move(bits));
+                Page p;
+                uint64_t offset;
+                while (in.readOne(p.mFirstKey))
+                {
+                    if (!in.readOne(offset))
+                    {
+                        throw xdr::xdr_runtime_error("truncated index file");
+                    }
+                    p.mOffset = static_cast<size_t>(offset);
+                    index->mPages.emplace_back(p);
+                }
+                valid = true;
+            }
+        }
+        catch (xdr::xdr_runtime_error& e)
+        {
+            CLOG(WARNING, "Bucket") << "Ignoring bad index file " << filename
+                                    << ": " << e.what();
+        }
+        if (valid)
+        {
+            return index;
+        }
+        index->mPages.clear();
+        index->mBloom = BloomFilter();
+    }
+
+    CLOG(DEBUG, "Bucket") << "Building index for bucket file "
+                          << bucketFilename;
+    XDRInputFileStream in;
+    in.open(bucketFilename);
+    BucketEntry e;
+    size_t offset = in.pos();
+    while (in.readOne(e))
+    {
+        index->add(e, offset);
+        offset = in.pos();
+    }
+    in.close();
+    index->finish();
+
+    if (!index->save(filename))
+    {
+        CLOG(WARNING, "Bucket") << "Failed to write index file " << filename;
+    }
+    return index;
+}
+
+bool
+BucketIndex::lookup(LedgerKey const& k, size_t& offset) const
+{
+    // Find the last page whose first key is <= k.
+    LedgerEntryIdCmp cmp;
+    auto i = std::upper_bound(
+        mPages.begin(), mPages.end(), k,
+        [&cmp](LedgerKey const& key, Page const& p) {
+            return cmp(key, p.mFirstKey);
+        });
+    if (i == mPages.begin())
+    {
+        return false;
+    }
+    offset = (i - 1)->mOffset;
+    return true;
+}
+}
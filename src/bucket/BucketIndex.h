@@ -0,0 +1,102 @@
+#pragma once
+
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/BloomFilter.h"
+#include "util/NonCopyable.h"
+#include "xdr/Stellar-ledger.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace stellar
+{
+
+/**
+ * BucketIndex is a compact, sorted page index over the entries of a bucket
+ * file: the file is divided into pages of roughly kPageSize bytes and, for
+ * each page, the index records the key of the first entry in it and the file
+ * offset at which that entry starts. A point lookup is then a binary search
+ * over the index followed by a read of a single page of the bucket file.
+ *
+ * The index also carries a bloom filter over the hashes of all keys in the
+ * bucket (see keyHash), which lets point lookups and shadow checks during
+ * merges skip buckets that definitely do not hold a key without touching the
+ * bucket file at all.
+ *
+ * Indexes are written by BucketOutputIterator alongside the bucket file they
+ * describe (see indexFilename) and moved with it when the BucketManager adopts
+ * the bucket. Buckets obtained some other way -- downloaded from history, or
+ * written by an older version -- have their index rebuilt by a single scan the
+ * first time it is needed.
+ */
+class BucketIndex : NonMovableOrCopyable
+{
+    struct Page
+    {
+        LedgerKey mFirstKey;
+        size_t mOffset;
+    };
+
+    std::vector<Page> mPages;
+    size_t mNextPageOffset{0};
+
+    // Key hashes accumulate here while the index is being built, until
+    // finish() sizes the bloom filter to fit them.
+    std::vector<uint64_t> mKeyHashes;
+    BloomFilter mBloom;
+
+  public:
+    // Approximate size of the region of the bucket file covered by each index
+    // entry.
+    static size_t const kPageSize;
+
+    // Name of the index file that accompanies the bucket file `bucketFilename`.
+    static std::string indexFilename(std::string const& bucketFilename);
+
+    // Load the index stored next to `bucketFilename`, or build it by scanning
+    // the bucket file (and try to store it for next time) if there is no
+    // usable index file.
+    static std::unique_ptr<BucketIndex>
+    loadOrBuild(std::string const& bucketFilename);
+
+    // The hash of `k` used by the bloom filter.
+    static uint64_t keyHash(LedgerKey const& k);
+
+    // Record that `e` is written to the bucket file at `offset`. Entries must
+    // be added in bucket order.
+    void add(BucketEntry const& e, size_t offset);
+
+    // Build the bloom filter once every entry has been added.
+    void finish();
+
+    // Returns false if the key with hash `keyHash` is definitely not in the
+    // bucket.
+    bool
+    mayContain(uint64_t keyHash) const
+    {
+        return mBloom.mayContain(keyHash);
+    }
+
+    // Write the index to `filename`, returning false (and removing any partial
+    // file) if writing fails.
+    bool save(std::string const& filename) const;
+
+    // If `k` may be present in the bucket, set `offset` to the position in the
+    // bucket file from which a forward scan will reach it (if it exists) and
+    // return true. Return false if `k` is definitely absent.
+    bool lookup(LedgerKey const& k, size_t& offset) const;
+
+    size_t
+    numPages() const
+    {
+        return mPages.size();
+    }
+};
+
+// Return the LedgerKey identifying a live or dead BucketEntry.
+LedgerKey getBucketEntryKey(BucketEntry const& e);
+}
@@ -14,7 +14,11 @@ namespace stellar
 void
 BucketInputIterator::loadEntry()
 {
-    if (mIn.readOne(mEntry))
+    if (mEntries)
+    {
+        mEntryPtr = mPos < mEntries->size() ? &(*mEntries)[mPos] : nullptr;
+    }
+    else if (mIn.readOne(mEntry))
     {
         mEntryPtr = &mEntry;
     }
@@ -35,9 +39,14 @@ BucketEntry const& BucketInputIterator::operator*()
 }
 
 BucketInputIterator::BucketInputIterator(std::shared_ptr<Bucket const> bucket)
-    : mBucket(bucket), mEntryPtr(nullptr)
+    : mBucket(bucket), mEntryPtr(nullptr), mEntries(nullptr), mPos(0)
 {
-    if (!mBucket->getFilename().empty())
+    if (mBucket->isInMemory())
+    {
+        mEntries = &mBucket->getInMemoryEntries();
+        loadEntry();
+    }
+    else if (!mBucket->getFilename().empty())
     {
         CLOG(TRACE, "Bucket") << "BucketInputIterator opening file to read: "
                               << mBucket->getFilename();
@@ -53,7 +62,12 @@ BucketInputIterator::~BucketInputIterator()
 
 BucketInputIterator& BucketInputIterator::operator++()
 {
-    if (mIn)
+    if (mEntries)
+    {
+        ++mPos;
+        loadEntry();
+    }
+    else if (mIn)
     {
         loadEntry();
     }
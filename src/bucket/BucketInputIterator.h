@@ -24,9 +24,13 @@ class BucketInputIterator
     // pointer. If
     // non-null, it points to mEntry.
     BucketEntry const* mEntryPtr;
-    XDRInputFileStream mIn;
+    XDRInputMappedFileStream mIn;
     BucketEntry mEntry;
 
+    // For an in-memory bucket, mEntryPtr points into its entries instead.
+    std::vector<BucketEntry> const* mEntries;
+    size_t mPos;
+
     void loadEntry();
 
   public:
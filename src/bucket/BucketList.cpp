@@ -10,6 +10,7 @@
 #include "crypto/Random.h"
 #include "crypto/SHA.h"
 #include "main/Application.h"
+#include "main/Config.h"
 #include "util/Logging.h"
 #include "util/XDRStream.h"
 #include "util/types.h"
@@ -120,7 +121,8 @@ BucketLevel::prepare(Application& app, uint32_t currLedger,
     }
 
     mNextCurr = FutureBucket(app, curr, snap, shadows,
-                             BucketList::keepDeadEntries(mLevel));
+                             BucketList::keepDeadEntries(mLevel),
+                             BucketList::keepInMemory(app, mLevel));
     assert(mNextCurr.isMerging());
 }
 
@@ -313,6 +315,12 @@ BucketList::keepDeadEntries(uint32_t level)
     return level < BucketList::kNumLevels - 1;
 }
 
+bool
+BucketList::keepInMemory(Application& app, uint32_t level)
+{
+    return level < app.getConfig().BUCKETLIST_IN_MEMORY_LEVELS;
+}
+
 BucketLevel&
 BucketList::getLevel(uint32_t i)
 {
@@ -411,7 +419,8 @@ BucketList::addBatch(Application& app, uint32_t currLedger,
     assert(shadows.size() == 0);
     mLevels[0].prepare(
         app, currLedger,
-        Bucket::fresh(app.getBucketManager(), liveEntries, deadEntries),
+        Bucket::fresh(app.getBucketManager(), liveEntries, deadEntries,
+                      keepInMemory(app, 0)),
         shadows);
     mLevels[0].commit();
 }
@@ -425,7 +434,7 @@ BucketList::restartMerges(Application& app)
         auto& next = level.getNext();
         if (next.hasHashes() && !next.isLive())
         {
-            next.makeLive(app, keepDeadEntries(i));
+            next.makeLive(app, keepDeadEntries(i), keepInMemory(app, i));
             if (next.isMerging())
             {
                 CLOG(INFO, "Bucket")
@@ -324,6 +324,10 @@ class BucketList
     // Returns true if at given `level` dead entries should be kept.
     static bool keepDeadEntries(uint32_t level);
 
+    // Returns true if buckets at given `level` should be kept in memory rather
+    // than written to files as they are made; see BUCKETLIST_IN_MEMORY_LEVELS.
+    static bool keepInMemory(Application& app, uint32_t level);
+
     // Create a new BucketList with every `kNumLevels` levels, each with
     // an empty bucket in `curr` and `snap`.
     BucketList();
@@ -11,6 +11,11 @@
 
 #include "medida/timer_context.h"
 
+namespace medida
+{
+class Meter;
+}
+
 namespace stellar
 {
 
@@ -56,6 +61,13 @@ class BucketManager : NonMovableOrCopyable
 
     virtual medida::Timer& getMergeTimer() = 0;
 
+    // Meters for bucket bloom filter queries made while checking shadows
+    // during merges: all queries, those the filter answered "definitely
+    // absent" and those it answered "maybe present" for an absent key.
+    virtual medida::Meter& getBloomLookupMeter() = 0;
+    virtual medida::Meter& getBloomNegativeMeter() = 0;
+    virtual medida::Meter& getBloomFalsePositiveMeter() = 0;
+
     // Get a reference to a persistent bucket (in the BucketManager's bucket
     // directory), from the BucketManager's shared bucket-set.
     //
@@ -71,9 +83,33 @@ class BucketManager : NonMovableOrCopyable
     adoptFileAsBucket(std::string const& filename, uint256 const& hash,
                       size_t nObjects = 0, size_t nBytes = 0) = 0;
 
+    // Like adoptFileAsBucket, but for a bucket kept in memory: if `hash` names
+    // an existing bucket, return that; otherwise return a new in-memory bucket
+    // holding `entries`, with the (finished) `index` its file form would have.
+    // The bucket's file is written behind, see writeBucketFiles.
+    virtual std::shared_ptr<Bucket>
+    adoptEntriesAsBucket(std::vector<BucketEntry>&& entries,
+                         std::unique_ptr<BucketIndex> index,
+                         uint256 const& hash, size_t nObjects = 0,
+                         size_t nBytes = 0) = 0;
+
     // Return a bucket by hash if we have it, else return nullptr.
     virtual std::shared_ptr<Bucket> getBucketByHash(uint256 const& hash) = 0;
 
+    // Make sure that the buckets named by `hexHashes` that are held in memory
+    // have a file in the bucket directory, so that a restart from a state
+    // naming them finds them. Each in-memory bucket is written out on the
+    // worker threads as soon as it is made (without syncing the file); this
+    // waits for those writes, and does itself any that no worker started.
+    // The buckets stay in memory.
+    virtual void
+    writeBucketFiles(std::vector<std::string> const& hexHashes) = 0;
+
+    // Like writeBucketFiles, then replace the in-memory buckets named by
+    // `hexHashes` with their file-backed form, so that they can be
+    // published.
+    virtual void persistBuckets(std::vector<std::string> const& hexHashes) = 0;
+
     // Forget any buckets not referenced by the current BucketList. This will
     // not immediately cause the buckets to delete themselves, if someone else
     // is using them via a shared_ptr<>, but the BucketManager will no longer
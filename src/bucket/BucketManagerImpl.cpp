@@ -3,12 +3,15 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "bucket/BucketManagerImpl.h"
+#include "bucket/BucketIndex.h"
 #include "bucket/BucketList.h"
+#include "bucket/BucketOutputIterator.h"
 #include "crypto/Hex.h"
 #include "history/HistoryManager.h"
 #include "main/Application.h"
 #include "main/Config.h"
 #include "overlay/StellarXDR.h"
+#include "util/ClaimableTask.h"
 #include "util/Fs.h"
 #include "util/Logging.h"
 #include "util/TmpDir.h"
@@ -62,6 +65,12 @@ BucketManagerImpl::BucketManagerImpl(Application& app)
           app.getMetrics().NewMeter({"bucket", "byte", "insert"}, "byte"))
     , mBucketAddBatch(app.getMetrics().NewTimer({"bucket", "batch", "add"}))
     , mBucketSnapMerge(app.getMetrics().NewTimer({"bucket", "snap", "merge"}))
+    , mBloomLookup(
+          app.getMetrics().NewMeter({"bucket", "bloom", "lookup"}, "lookup"))
+    , mBloomNegative(
+          app.getMetrics().NewMeter({"bucket", "bloom", "negative"}, "lookup"))
+    , mBloomFalsePositive(app.getMetrics().NewMeter(
+          {"bucket", "bloom", "false-positive"}, "lookup"))
     , mSharedBucketsSize(
           app.getMetrics().NewCounter({"bucket", "memory", "shared"}))
 
@@ -143,6 +152,24 @@ BucketManagerImpl::getMergeTimer()
     return mBucketSnapMerge;
 }
 
+medida::Meter&
+BucketManagerImpl::getBloomLookupMeter()
+{
+    return mBloomLookup;
+}
+
+medida::Meter&
+BucketManagerImpl::getBloomNegativeMeter()
+{
+    return mBloomNegative;
+}
+
+medida::Meter&
+BucketManagerImpl::getBloomFalsePositiveMeter()
+{
+    return mBloomFalsePositive;
+}
+
 std::shared_ptr<Bucket>
 BucketManagerImpl::adoptFileAsBucket(std::string const& filename,
                                      uint256 const& hash, size_t nObjects,
@@ -156,6 +183,7 @@ BucketManagerImpl::adoptFileAsBucket(std::string const& filename,
         CLOG(DEBUG, "Bucket") << "Deleting bucket file " << filename
                               << " that is redundant with existing bucket";
         std::remove(filename.c_str());
+        std::remove(BucketIndex::indexFilename(filename).c_str());
     }
     else
     {
@@ -171,6 +199,18 @@ BucketManagerImpl::adoptFileAsBucket(std::string const& filename,
             throw std::runtime_error(err);
         }
 
+        // The index is only an accelerator: if it is missing or can't be
+        // moved, it gets rebuilt the first time it's needed.
+        std::string indexName = BucketIndex::indexFilename(filename);
+        if (fs::exists(indexName) &&
+            rename(indexName.c_str(),
+                   BucketIndex::indexFilename(canonicalName).c_str()) != 0)
+        {
+            CLOG(WARNING, "Bucket") << "Failed to rename bucket index "
+                                    << indexName << ": " << strerror(errno);
+            std::remove(indexName.c_str());
+        }
+
         b = std::make_shared<Bucket>(canonicalName, hash);
         {
             mSharedBuckets.insert(std::make_pair(hash, b));
@@ -181,6 +221,160 @@ BucketManagerImpl::adoptFileAsBucket(std::string const& filename,
     return b;
 }
 
+std::shared_ptr<Bucket>
+BucketManagerImpl::adoptEntriesAsBucket(std::vector<BucketEntry>&& entries,
+                                        std::unique_ptr<BucketIndex> index,
+                                        uint256 const& hash, size_t nObjects,
+                                        size_t nBytes)
+{
+    std::lock_guard<std::recursive_mutex> lock(mBucketMutex);
+    std::shared_ptr<Bucket> b = getBucketByHash(hash);
+    if (!b)
+    {
+        mBucketObjectInsert.Mark(nObjects);
+        mBucketByteInsert.Mark(nBytes);
+        CLOG(DEBUG, "Bucket")
+            << "Adopting in-memory bucket " << binToHex(hash);
+        b = std::make_shared<Bucket>(std::move(entries), std::move(index),
+                                     hash);
+        mSharedBuckets.insert(std::make_pair(hash, b));
+        mSharedBucketsSize.set_count(mSharedBuckets.size());
+
+        // The state stored at each ledger close names the buckets of the
+        // in-memory levels, so their files must exist by then for a restart
+        // to find them; write them out now, off the ledger close.
+        auto write = std::make_shared<ClaimableTask>(
+            [this, b]() { writeBucketFile(*b); });
+        mBucketWrites[hash] = write;
+        mApp.getWorkerIOService().post([this, hash, write]() {
+            // a failed write is retried, and reported, by writeBucketFiles
+            write->run();
+            finishBucketWrite(hash, write);
+        });
+    }
+    return b;
+}
+
+void
+BucketManagerImpl::writeBucketFile(Bucket const& bucket)
+{
+    std::string canonicalName = bucketFilename(bucket.getHash());
+    if (fs::exists(canonicalName))
+    {
+        return;
+    }
+
+    // written aside and renamed into place, so that a stop in the middle
+    // never leaves a partial bucket file
+    std::string tmpName =
+        getTmpDir() + "/write-" + binToHex(bucket.getHash()) + ".xdr";
+    CLOG(DEBUG, "Bucket") << "Writing in-memory bucket "
+                          << binToHex(bucket.getHash());
+    {
+        XDROutputFileStream out;
+        out.open(tmpName);
+        for (auto const& e : bucket.getInMemoryEntries())
+        {
+            out.writeOne(e);
+        }
+        out.close();
+    }
+    if (rename(tmpName.c_str(), canonicalName.c_str()) != 0)
+    {
+        std::string err("Failed to rename bucket :");
+        err += strerror(errno);
+        std::remove(tmpName.c_str());
+        throw std::runtime_error(err);
+    }
+}
+
+void
+BucketManagerImpl::finishBucketWrite(
+    Hash const& hash, std::shared_ptr<ClaimableTask> const& write)
+{
+    std::lock_guard<std::recursive_mutex> lock(mBucketMutex);
+    auto i = mBucketWrites.find(hash);
+    if (i != mBucketWrites.end() && i->second == write)
+    {
+        mBucketWrites.erase(i);
+    }
+}
+
+void
+BucketManagerImpl::writeBucketFiles(std::vector<std::string> const& hexHashes)
+{
+    // the writes are waited for without the lock, which the worker writing
+    // a bucket needs to finish
+    std::vector<std::pair<Hash, std::shared_ptr<ClaimableTask>>> writes;
+    std::vector<std::shared_ptr<Bucket>> unwritten;
+    {
+        std::lock_guard<std::recursive_mutex> lock(mBucketMutex);
+        for (auto const& h : hexHashes)
+        {
+            auto hash = hexToBin256(h);
+            auto i = mSharedBuckets.find(hash);
+            if (i == mSharedBuckets.end() || !i->second->isInMemory())
+            {
+                continue;
+            }
+            auto w = mBucketWrites.find(hash);
+            if (w != mBucketWrites.end())
+            {
+                writes.emplace_back(hash, w->second);
+            }
+            else
+            {
+                // its write failed
+                unwritten.emplace_back(i->second);
+            }
+        }
+    }
+
+    for (auto const& w : writes)
+    {
+        try
+        {
+            w.second->wait();
+        }
+        catch (std::exception& e)
+        {
+            CLOG(WARNING, "Bucket") << "Failed to write in-memory bucket "
+                                    << binToHex(w.first) << ": " << e.what()
+                                    << ", retrying";
+            std::lock_guard<std::recursive_mutex> lock(mBucketMutex);
+            auto i = mSharedBuckets.find(w.first);
+            if (i != mSharedBuckets.end() && i->second->isInMemory())
+            {
+                unwritten.emplace_back(i->second);
+            }
+        }
+        finishBucketWrite(w.first, w.second);
+    }
+    for (auto const& b : unwritten)
+    {
+        writeBucketFile(*b);
+    }
+}
+
+void
+BucketManagerImpl::persistBuckets(std::vector<std::string> const& hexHashes)
+{
+    writeBucketFiles(hexHashes);
+
+    // Anyone still holding an in-memory bucket keeps using it; it is
+    // identical to the file-backed one.
+    std::lock_guard<std::recursive_mutex> lock(mBucketMutex);
+    for (auto const& h : hexHashes)
+    {
+        auto hash = hexToBin256(h);
+        auto i = mSharedBuckets.find(hash);
+        if (i != mSharedBuckets.end() && i->second->isInMemory())
+        {
+            i->second = std::make_shared<Bucket>(bucketFilename(hash), hash);
+        }
+    }
+}
+
 std::shared_ptr<Bucket>
 BucketManagerImpl::getBucketByHash(uint256 const& hash)
 {
@@ -264,10 +458,16 @@ BucketManagerImpl::forgetUnreferencedBuckets()
             CLOG(TRACE, "Bucket")
                 << "BucketManager::forgetUnreferencedBuckets dropping "
                 << filename;
+            if (filename.empty() && j->second->isInMemory())
+            {
+                // the file written behind, if any
+                filename = bucketFilename(j->first);
+            }
             if (!filename.empty())
             {
                 CLOG(TRACE, "Bucket") << "removing bucket file: " << filename;
                 std::remove(filename.c_str());
+                std::remove(BucketIndex::indexFilename(filename).c_str());
             }
             mSharedBuckets.erase(j);
         }
@@ -358,5 +558,20 @@ BucketManagerImpl::shutdown()
 {
     // forgetUnreferencedBuckets does what we want - it retains needed buckets
     forgetUnreferencedBuckets();
+
+    // Whatever is retained may be needed on restart, so make sure none of it
+    // exists only in memory.
+    std::vector<std::string> retained;
+    {
+        std::lock_guard<std::recursive_mutex> lock(mBucketMutex);
+        for (auto const& b : mSharedBuckets)
+        {
+            if (b.second->isInMemory())
+            {
+                retained.emplace_back(binToHex(b.first));
+            }
+        }
+    }
+    persistBuckets(retained);
 }
 }
@@ -24,6 +24,7 @@ namespace stellar
 {
 
 class TmpDir;
+class ClaimableTask;
 class Application;
 class Bucket;
 class BucketList;
@@ -43,8 +44,19 @@ class BucketManagerImpl : public BucketManager
     medida::Meter& mBucketByteInsert;
     medida::Timer& mBucketAddBatch;
     medida::Timer& mBucketSnapMerge;
+    medida::Meter& mBloomLookup;
+    medida::Meter& mBloomNegative;
+    medida::Meter& mBloomFalsePositive;
     medida::Counter& mSharedBucketsSize;
 
+    // writes of in-memory buckets to the bucket directory, by hash, that
+    // have not finished yet
+    std::map<Hash, std::shared_ptr<ClaimableTask>> mBucketWrites;
+
+    void writeBucketFile(Bucket const& bucket);
+    void finishBucketWrite(Hash const& hash,
+                           std::shared_ptr<ClaimableTask> const& write);
+
   protected:
     void calculateSkipValues(LedgerHeader& currentHeader);
     std::string bucketFilename(std::string const& bucketHexHash);
@@ -57,11 +69,21 @@ class BucketManagerImpl : public BucketManager
     std::string const& getBucketDir() override;
     BucketList& getBucketList() override;
     medida::Timer& getMergeTimer() override;
+    medida::Meter& getBloomLookupMeter() override;
+    medida::Meter& getBloomNegativeMeter() override;
+    medida::Meter& getBloomFalsePositiveMeter() override;
     std::shared_ptr<Bucket> adoptFileAsBucket(std::string const& filename,
                                               uint256 const& hash,
                                               size_t nObjects,
                                               size_t nBytes) override;
+    std::shared_ptr<Bucket>
+    adoptEntriesAsBucket(std::vector<BucketEntry>&& entries,
+                         std::unique_ptr<BucketIndex> index,
+                         uint256 const& hash, size_t nObjects,
+                         size_t nBytes) override;
     std::shared_ptr<Bucket> getBucketByHash(uint256 const& hash) override;
+    void writeBucketFiles(std::vector<std::string> const& hexHashes) override;
+    void persistBuckets(std::vector<std::string> const& hexHashes) override;
 
     void forgetUnreferencedBuckets() override;
     void addBatch(Application& app, uint32_t currLedger,
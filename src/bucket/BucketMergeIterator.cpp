@@ -0,0 +1,94 @@
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "bucket/BucketMergeIterator.h"
+#include "bucket/Bucket.h"
+#include <algorithm>
+#include <cassert>
+
+namespace stellar
+{
+
+/**
+ * Returns true if iterator `a` should come out of the heap _after_ iterator
+ * `b`. std::*_heap functions build a max-heap, so the comparison is inverted
+ * relative to the order we want entries produced in.
+ */
+bool
+BucketMergeIterator::heapCmp(size_t a, size_t b)
+{
+    BucketEntryIdCmp cmp;
+    auto const& ea = *mIters[a];
+    auto const& eb = *mIters[b];
+    if (cmp(eb, ea))
+    {
+        return true;
+    }
+    if (cmp(ea, eb))
+    {
+        return false;
+    }
+    // Same key: lower index means newer bucket, which must win.
+    return a > b;
+}
+
+void
+BucketMergeIterator::popTop()
+{
+    auto cmp = [this](size_t a, size_t b) { return heapCmp(a, b); };
+    std::pop_heap(mHeap.begin(), mHeap.end(), cmp);
+    auto i = mHeap.back();
+    mHeap.pop_back();
+    ++mIters[i];
+    if (mIters[i])
+    {
+        mHeap.push_back(i);
+        std::push_heap(mHeap.begin(), mHeap.end(), cmp);
+    }
+}
+
+BucketMergeIterator::BucketMergeIterator(
+    std::vector<std::shared_ptr<Bucket>> const& buckets)
+    : mIters(buckets.begin(), buckets.end())
+{
+    for (size_t i = 0; i < mIters.size(); ++i)
+    {
+        if (mIters[i])
+        {
+            mHeap.push_back(i);
+        }
+    }
+    std::make_heap(mHeap.begin(), mHeap.end(),
+                   [this](size_t a, size_t b) { return heapCmp(a, b); });
+}
+
+BucketMergeIterator::operator bool() const
+{
+    return !mHeap.empty();
+}
+
+BucketEntry const& BucketMergeIterator::operator*()
+{
+    assert(!mHeap.empty());
+    return *mIters[mHeap.front()];
+}
+
+BucketMergeIterator& BucketMergeIterator::operator++()
+{
+    assert(!mHeap.empty());
+
+    // Advance the newest iterator past the current key, then every older
+    // iterator that is still sitting on a key-wise identical (and therefore
+    // shadowed) entry.
+    BucketEntry current = **this;
+    popTop();
+
+    BucketEntryIdCmp cmp;
+    while (!mHeap.empty() && !cmp(current, *mIters[mHeap.front()]))
+    {
+        popTop();
+    }
+    return *this;
+}
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "bucket/BucketInputIterator.h"
+#include "bucket/LedgerCmp.h"
+#include "xdr/Stellar-ledger.h"
+
+#include <memory>
+#include <vector>
+
+namespace stellar
+{
+
+class Bucket;
+
+// Helper class that streams the logical union of a sequence of buckets in a
+// single pass, without writing any intermediate bucket files. The buckets must
+// be given newest-first: when several buckets hold key-wise identical entries,
+// only the one from the newest bucket is produced. Dead entries are produced
+// like any other entry; callers that want the live set should skip them.
+class BucketMergeIterator
+{
+    std::vector<BucketInputIterator> mIters;
+
+    // Heap of indexes into mIters of the non-exhausted iterators, ordered
+    // such that the front of the heap is the iterator with the smallest
+    // current entry (ties broken in favour of the newest bucket).
+    std::vector<size_t> mHeap;
+
+    bool heapCmp(size_t a, size_t b);
+    void popTop();
+
+  public:
+    BucketMergeIterator(std::vector<std::shared_ptr<Bucket>> const& buckets);
+
+    operator bool() const;
+
+    BucketEntry const& operator*();
+
+    BucketMergeIterator& operator++();
+};
+}
@@ -31,18 +31,43 @@ randomBucketName(std::string const& tmpDir)
 
 /**
  * Helper class that points to an output tempfile. Absorbs BucketEntries and
- * hashes them while writing to either destination. Produces a Bucket when done.
+ * hashes and indexes them while writing to either destination. Produces a
+ * Bucket when done.
  */
 BucketOutputIterator::BucketOutputIterator(std::string const& tmpDir,
-                                           bool keepDeadEntries)
-    : mFilename(randomBucketName(tmpDir))
-    , mBuf(nullptr)
+                                           bool keepDeadEntries, bool inMemory)
+    : mBuf(nullptr)
     , mHasher(SHA256::create())
+    , mIndex(make_unique<BucketIndex>())
     , mKeepDeadEntries(keepDeadEntries)
+    , mInMemory(inMemory)
 {
-    CLOG(TRACE, "Bucket") << "BucketOutputIterator opening file to write: "
-                          << mFilename;
-    mOut.open(mFilename);
+    if (!mInMemory)
+    {
+        mFilename = randomBucketName(tmpDir);
+        CLOG(TRACE, "Bucket")
+            << "BucketOutputIterator opening file to write: " << mFilename;
+        mOut.open(mFilename);
+    }
+}
+
+void
+BucketOutputIterator::write(BucketEntry const& e)
+{
+    mIndex->add(e, mBytesPut);
+    if (mInMemory)
+    {
+        // Hash exactly the bytes the file form would hold.
+        uint32_t sz = xdrFrameRecord(e, mFrameBuf);
+        mHasher->add(ByteSlice(mFrameBuf.data(), sz));
+        mBytesPut += sz;
+        mEntries.emplace_back(e);
+    }
+    else
+    {
+        mOut.writeOne(e, mHasher.get(), &mBytesPut);
+    }
+    mObjectsPut++;
 }
 
 void
@@ -64,8 +89,7 @@ BucketOutputIterator::put(BucketEntry const& e)
         // merely replace (same identity), the buffered entry.
         if (mCmp(*mBuf, e))
         {
-            mOut.writeOne(*mBuf, mHasher.get(), &mBytesPut);
-            mObjectsPut++;
+            write(*mBuf);
         }
     }
     else
@@ -80,14 +104,25 @@ BucketOutputIterator::put(BucketEntry const& e)
 std::shared_ptr<Bucket>
 BucketOutputIterator::getBucket(BucketManager& bucketManager)
 {
-    assert(mOut);
+    assert(mInMemory || mOut);
     if (mBuf)
     {
-        mOut.writeOne(*mBuf, mHasher.get(), &mBytesPut);
-        mObjectsPut++;
+        write(*mBuf);
         mBuf.reset();
     }
 
+    if (mInMemory)
+    {
+        if (mObjectsPut == 0)
+        {
+            return std::make_shared<Bucket>();
+        }
+        mIndex->finish();
+        return bucketManager.adoptEntriesAsBucket(
+            std::move(mEntries), std::move(mIndex), mHasher->finish(),
+            mObjectsPut, mBytesPut);
+    }
+
     mOut.close();
     if (mObjectsPut == 0 || mBytesPut == 0)
     {
@@ -97,6 +132,12 @@ BucketOutputIterator::getBucket(BucketManager& bucketManager)
         std::remove(mFilename.c_str());
         return std::make_shared<Bucket>();
     }
+    mIndex->finish();
+    if (!mIndex->save(BucketIndex::indexFilename(mFilename)))
+    {
+        CLOG(WARNING, "Bucket") << "Failed to write index for " << mFilename
+                                << ", it will be rebuilt on demand";
+    }
     return bucketManager.adoptFileAsBucket(mFilename, mHasher->finish(),
                                            mObjectsPut, mBytesPut);
 }
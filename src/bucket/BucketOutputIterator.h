@@ -4,6 +4,7 @@
 // under the Apache License, Version 2.0. See the COPYING file at the root
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
+#include "bucket/BucketIndex.h"
 #include "bucket/LedgerCmp.h"
 #include "util/XDRStream.h"
 #include "xdr/Stellar-ledger.h"
@@ -17,8 +18,10 @@ namespace stellar
 class Bucket;
 class BucketManager;
 
-// Helper class that writes new elements to a file and returns a bucket
-// when finished.
+// Helper class that writes new elements to a file, along with its index, and
+// returns a bucket when finished. In in-memory mode, the elements are instead
+// kept in a vector and the returned bucket has no file, but its hash and index
+// are exactly those the file form would have.
 class BucketOutputIterator
 {
     std::string mFilename;
@@ -26,12 +29,19 @@ class BucketOutputIterator
     BucketEntryIdCmp mCmp;
     std::unique_ptr<BucketEntry> mBuf;
     std::unique_ptr<SHA256> mHasher;
+    std::unique_ptr<BucketIndex> mIndex;
     size_t mBytesPut{0};
     size_t mObjectsPut{0};
     bool mKeepDeadEntries{true};
+    bool mInMemory{false};
+    std::vector<BucketEntry> mEntries;
+    std::vector<char> mFrameBuf;
+
+    void write(BucketEntry const& e);
 
   public:
-    BucketOutputIterator(std::string const& tmpDir, bool keepDeadEntries);
+    BucketOutputIterator(std::string const& tmpDir, bool keepDeadEntries,
+                         bool inMemory = false);
 
     void put(BucketEntry const& e);
 
@@ -7,14 +7,18 @@
 // else.
 #include "util/asio.h"
 #include "bucket/Bucket.h"
+#include "bucket/BucketApplicator.h"
+#include "bucket/BucketIndex.h"
 #include "bucket/BucketInputIterator.h"
 #include "bucket/BucketList.h"
 #include "bucket/BucketManager.h"
 #include "bucket/BucketManagerImpl.h"
+#include "bucket/BucketMergeIterator.h"
 #include "bucket/LedgerCmp.h"
 #include "crypto/Hex.h"
 #include "database/Database.h"
 #include "herder/LedgerCloseData.h"
+#include "ledger/EntryFrame.h"
 #include "ledger/LedgerManager.h"
 #include "ledger/LedgerTestUtils.h"
 #include "lib/catch.hpp"
@@ -31,7 +35,10 @@
 #include "util/types.h"
 #include "xdrpp/autocheck.h"
 #include <algorithm>
+#include <chrono>
 #include <future>
+#include <map>
+#include <set>
 
 using namespace stellar;
 
@@ -398,6 +405,59 @@ TEST_CASE("duplicate bucket entries", "[bucket]")
     }
 }
 
+TEST_CASE("in-memory bucket levels", "[bucket][bucketinmemory]")
+{
+    VirtualClock clock0, clock1;
+    Config cfg0(getTestConfig(0));
+    Config cfg1(getTestConfig(1));
+    cfg1.BUCKETLIST_IN_MEMORY_LEVELS = 3;
+
+    Application::pointer app0 = createTestApplication(clock0, cfg0);
+    Application::pointer app1 = createTestApplication(clock1, cfg1);
+    BucketList bl0, bl1;
+    autocheck::generator<std::vector<LedgerKey>> deadGen;
+    for (uint32_t i = 1; i < 130; ++i)
+    {
+        auto live = LedgerTestUtils::generateValidLedgerEntries(8);
+        auto dead = deadGen(8);
+        bl0.addBatch(*app0, i, live, dead);
+        bl1.addBatch(*app1, i, live, dead);
+        for (uint32_t j = 0; j < BucketList::kNumLevels; ++j)
+        {
+            REQUIRE(bl0.getLevel(j).getHash() == bl1.getLevel(j).getHash());
+        }
+    }
+
+    auto& bm = app1->getBucketManager();
+    for (uint32_t j = 0; j < BucketList::kNumLevels; ++j)
+    {
+        auto curr = bl1.getLevel(j).getCurr();
+        if (isZero(curr->getHash()))
+        {
+            continue;
+        }
+        REQUIRE(curr->isInMemory() == (j < cfg1.BUCKETLIST_IN_MEMORY_LEVELS));
+        if (curr->isInMemory())
+        {
+            REQUIRE(curr->getFilename().empty());
+            bm.persistBuckets({binToHex(curr->getHash())});
+            auto persisted = bm.getBucketByHash(curr->getHash());
+            REQUIRE(persisted);
+            REQUIRE(!persisted->isInMemory());
+            REQUIRE(fs::exists(persisted->getFilename()));
+            REQUIRE(persisted->getHash() == curr->getHash());
+
+            BucketInputIterator a(curr), b(persisted);
+            for (; a && b; ++a, ++b)
+            {
+                REQUIRE(*a == *b);
+            }
+            REQUIRE(!a);
+            REQUIRE(!b);
+        }
+    }
+}
+
 TEST_CASE("bucket tombstones expire at bottom level", "[bucket][tombstones]")
 {
     VirtualClock clock;
@@ -596,6 +656,167 @@ TEST_CASE("merging bucket entries", "[bucket]")
     }
 }
 
+TEST_CASE("merge iterator matches pairwise merges", "[bucket][bucketmerge]")
+{
+    VirtualClock clock;
+    Config const& cfg = getTestConfig();
+    Application::pointer app = createTestApplication(clock, cfg);
+    auto& bm = app->getBucketManager();
+
+    autocheck::generator<bool> flip;
+    std::vector<LedgerEntry> entries =
+        LedgerTestUtils::generateValidLedgerEntries(200);
+
+    // Build a sequence of buckets, newest first, each of which overwrites or
+    // deletes a random subset of the same keys.
+    std::vector<std::shared_ptr<Bucket>> buckets;
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        std::vector<LedgerEntry> live;
+        std::vector<LedgerKey> dead;
+        for (auto& e : entries)
+        {
+            if (flip())
+            {
+                e.lastModifiedLedgerSeq = 8 - i;
+                live.push_back(e);
+            }
+            else if (flip() && flip())
+            {
+                dead.push_back(LedgerEntryKey(e));
+            }
+        }
+        buckets.push_back(Bucket::fresh(bm, live, dead));
+    }
+    buckets.push_back(std::make_shared<Bucket>());
+
+    auto superBucket = buckets.front();
+    for (auto i = buckets.begin() + 1; i != buckets.end(); ++i)
+    {
+        superBucket = Bucket::merge(bm, *i, superBucket);
+    }
+
+    size_t n = 0;
+    BucketInputIterator expected(superBucket);
+    for (BucketMergeIterator iter(buckets); iter; ++iter, ++expected)
+    {
+        REQUIRE(expected);
+        REQUIRE(xdr::xdr_to_opaque(*iter) == xdr::xdr_to_opaque(*expected));
+        ++n;
+    }
+    REQUIRE(!expected);
+    REQUIRE(n == countEntries(superBucket));
+}
+
+TEST_CASE("bucket index point lookups", "[bucket][bucketindex]")
+{
+    VirtualClock clock;
+    Config const& cfg = getTestConfig();
+    Application::pointer app = createTestApplication(clock, cfg);
+    auto& bm = app->getBucketManager();
+
+    std::vector<LedgerEntry> live =
+        LedgerTestUtils::generateValidLedgerEntries(2000);
+    std::vector<LedgerKey> dead;
+    for (size_t i = 0; i < live.size() / 10; ++i)
+    {
+        dead.push_back(LedgerEntryKey(live.back()));
+        live.pop_back();
+    }
+    std::vector<LedgerEntry> absent =
+        LedgerTestUtils::generateValidLedgerEntries(100);
+
+    std::shared_ptr<Bucket> b = Bucket::fresh(bm, live, dead);
+    REQUIRE(fs::exists(BucketIndex::indexFilename(b->getFilename())));
+
+    auto checkLookups = [&](std::shared_ptr<Bucket> bucket) {
+        for (auto const& e : live)
+        {
+            auto found = bucket->getEntry(LedgerEntryKey(e));
+            REQUIRE(found);
+            REQUIRE(found->type() == LIVEENTRY);
+            REQUIRE(xdr::xdr_to_opaque(found->liveEntry()) ==
+                    xdr::xdr_to_opaque(e));
+        }
+        for (auto const& k : dead)
+        {
+            auto found = bucket->getEntry(k);
+            REQUIRE(found);
+            REQUIRE(found->type() == DEADENTRY);
+        }
+        for (auto const& e : absent)
+        {
+            REQUIRE(!bucket->getEntry(LedgerEntryKey(e)));
+        }
+    };
+
+    SECTION("using the index written with the bucket")
+    {
+        checkLookups(b);
+    }
+
+    SECTION("rebuilding a missing index")
+    {
+        std::remove(BucketIndex::indexFilename(b->getFilename()).c_str());
+        checkLookups(b);
+        REQUIRE(fs::exists(BucketIndex::indexFilename(b->getFilename())));
+    }
+}
+
+TEST_CASE("bucket bloom filters", "[bucket][bucketbloom]")
+{
+    VirtualClock clock;
+    Config const& cfg = getTestConfig();
+    Application::pointer app = createTestApplication(clock, cfg);
+    auto& bm = app->getBucketManager();
+
+    std::vector<LedgerEntry> live =
+        LedgerTestUtils::generateValidLedgerEntries(1000);
+    std::vector<LedgerKey> noDead;
+    std::shared_ptr<Bucket> b = Bucket::fresh(bm, live, noDead);
+
+    SECTION("no false negatives")
+    {
+        for (auto const& e : live)
+        {
+            REQUIRE(b->getIndex().mayContain(
+                BucketIndex::keyHash(LedgerEntryKey(e))));
+        }
+    }
+
+    SECTION("few false positives")
+    {
+        size_t positives = 0;
+        auto absent = LedgerTestUtils::generateValidLedgerEntries(1000);
+        for (auto const& e : absent)
+        {
+            if (b->getIndex().mayContain(
+                    BucketIndex::keyHash(LedgerEntryKey(e))))
+            {
+                ++positives;
+            }
+        }
+        REQUIRE(positives < 50);
+    }
+
+    SECTION("shadow checks consult the filter")
+    {
+        std::vector<LedgerEntry> shadowed(live.begin(), live.begin() + 100);
+        auto shadow = Bucket::fresh(bm, shadowed, noDead);
+        auto other = Bucket::fresh(
+            bm, LedgerTestUtils::generateValidLedgerEntries(1000), noDead);
+        auto& lookups = bm.getBloomLookupMeter();
+        auto& negatives = bm.getBloomNegativeMeter();
+        auto n = lookups.count();
+        auto neg = negatives.count();
+
+        auto merged = Bucket::merge(bm, other, b, {shadow});
+        REQUIRE(countEntries(merged) == 2000 - shadowed.size());
+        REQUIRE(lookups.count() - n == 2000);
+        REQUIRE(negatives.count() - neg > 1800);
+    }
+}
+
 static void
 clearFutures(Application::pointer app, BucketList& bl)
 {
@@ -896,6 +1117,47 @@ TEST_CASE("bucket persistence over app restart", "[bucket][bucketpersist]")
     }
 }
 
+TEST_CASE("in-memory bucket levels survive an unclean stop",
+          "[bucket][bucketinmemory][bucketpersist]")
+{
+    std::vector<stellar::LedgerKey> emptySet;
+
+    VirtualClock clock;
+    Config cfg(getTestConfig(0, Config::TESTDB_ON_DISK_SQLITE));
+    cfg.BUCKETLIST_IN_MEMORY_LEVELS = 3;
+
+    Hash lclHash, blHash;
+    {
+        Application::pointer app = createTestApplication(clock, cfg);
+        app->start();
+        BucketList& bl = app->getBucketManager().getBucketList();
+        for (uint32_t i = 2; i < 40; i++)
+        {
+            bl.addBatch(*app, i,
+                        LedgerTestUtils::generateValidLedgerEntries(8),
+                        emptySet);
+        }
+        lclHash = closeLedger(*app);
+        blHash = bl.getHash();
+        REQUIRE(bl.getLevel(0).getCurr()->isInMemory());
+        REQUIRE(bl.getLevel(1).getCurr()->isInMemory());
+
+        // destroyed without a graceful stop, which would have written out
+        // every in-memory bucket
+    }
+
+    cfg.FORCE_SCP = false;
+    {
+        Application::pointer app = Application::create(clock, cfg, false);
+        app->start();
+        REQUIRE(hexAbbrev(lclHash) ==
+                hexAbbrev(
+                    app->getLedgerManager().getLastClosedLedgerHeader().hash));
+        REQUIRE(hexAbbrev(blHash) ==
+                hexAbbrev(app->getBucketManager().getBucketList().getHash()));
+    }
+}
+
 TEST_CASE("BucketList sizeOf* and oldestLedgerIn* relations", "[bucket][count]")
 {
     std::default_random_engine gen;
@@ -1109,6 +1371,140 @@ TEST_CASE("bucket apply", "[bucket]")
     REQUIRE(count == 1);
 }
 
+static void
+applyBucket(Application& app, std::shared_ptr<Bucket const> bucket)
+{
+    BucketApplicator applicator(app, bucket);
+    while (applicator)
+    {
+        applicator.advance();
+    }
+}
+
+static void
+checkBucketApplyWritesEveryEntryType(Application& app)
+{
+    // Key the entries so that duplicates generated at random collapse the
+    // same way they do in the bucket.
+    std::map<LedgerKey, LedgerEntry, LedgerEntryIdCmp> entries;
+    for (auto const& e : LedgerTestUtils::generateValidLedgerEntries(1000))
+    {
+        entries[LedgerEntryKey(e)] = e;
+    }
+    std::vector<LedgerEntry> live, noLive;
+    std::vector<LedgerKey> dead, noDead;
+    for (auto const& kv : entries)
+    {
+        live.emplace_back(kv.second);
+        if (dead.size() < entries.size() / 2)
+        {
+            dead.emplace_back(kv.first);
+        }
+    }
+
+    auto& db = app.getDatabase();
+    applyBucket(app, Bucket::fresh(app.getBucketManager(), live, noDead));
+    for (auto const& e : live)
+    {
+        REQUIRE(EntryFrame::checkAgainstDatabase(e, db) == "");
+    }
+
+    applyBucket(app, Bucket::fresh(app.getBucketManager(), noLive, dead));
+    std::set<LedgerKey, LedgerEntryIdCmp> deadSet(dead.begin(), dead.end());
+    for (auto const& kv : entries)
+    {
+        bool wasDeleted = deadSet.find(kv.first) != deadSet.end();
+        REQUIRE(EntryFrame::exists(db, kv.first) == !wasDeleted);
+    }
+}
+
+TEST_CASE("bucket apply writes every entry type", "[bucket]")
+{
+    VirtualClock clock;
+    Config cfg(getTestConfig());
+    Application::pointer app = createTestApplication(clock, cfg);
+    app->start();
+    checkBucketApplyWritesEveryEntryType(*app);
+}
+
+#ifdef USE_POSTGRES
+TEST_CASE("parallel bucket apply writes every entry type", "[bucket]")
+{
+    VirtualClock clock;
+    Config cfg(getTestConfig(0, Config::TESTDB_POSTGRESQL));
+    cfg.PARALLEL_BUCKET_APPLY = true;
+    Application::pointer app = createTestApplication(clock, cfg);
+    app->start();
+    REQUIRE(BucketApplicator::canApplyInParallel(*app));
+    checkBucketApplyWritesEveryEntryType(*app);
+}
+#endif
+
+template <typename Stream>
+static void
+benchBucketFileRead(std::string const& streamName, std::string const& filename,
+                    size_t expectedRecords)
+{
+    Stream in;
+    BucketEntry e;
+    size_t n = 0;
+    auto start = std::chrono::steady_clock::now();
+    in.open(filename);
+    while (in.readOne(e))
+    {
+        ++n;
+    }
+    in.close();
+    auto secs = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                              start)
+                    .count();
+    REQUIRE(n == expectedRecords);
+    CLOG(INFO, "Bucket") << streamName << ": read " << n << " records in "
+                         << secs << "s, " << (n / secs) << " records/sec";
+}
+
+TEST_CASE("bucket file read bench", "[bucketbench][hide]")
+{
+    VirtualClock clock;
+    Config const& cfg = getTestConfig();
+    Application::pointer app = createTestApplication(clock, cfg);
+
+    // Write a multi-GB bucket-format file by cycling through a pool of random
+    // entries; sortedness doesn't matter to the readers being measured.
+    size_t const targetBytes = size_t(2) << 30;
+    std::vector<BucketEntry> pool(10000);
+    for (auto& e : pool)
+    {
+        e.type(LIVEENTRY);
+        e.liveEntry() = LedgerTestUtils::generateValidLedgerEntry(5);
+    }
+
+    std::string filename =
+        app->getBucketManager().getTmpDir() + "/bench-bucket.xdr";
+    size_t bytes = 0, records = 0;
+    {
+        XDROutputFileStream out;
+        out.open(filename);
+        while (bytes < targetBytes)
+        {
+            REQUIRE(out.writeOne(pool[records % pool.size()], nullptr, &bytes));
+            ++records;
+        }
+        out.close();
+    }
+    CLOG(INFO, "Bucket") << "Wrote " << records << " records, " << bytes
+                         << " bytes";
+
+    // Alternate the readers so neither benefits unfairly from a warm cache.
+    for (int i = 0; i < 2; ++i)
+    {
+        benchBucketFileRead<XDRInputFileStream>("ifstream", filename, records);
+        benchBucketFileRead<XDRInputMappedFileStream>("mmap", filename,
+                                                      records);
+    }
+    std::remove(filename.c_str());
+}
+
 #ifdef USE_POSTGRES
 TEST_CASE("bucket apply bench", "[bucketbench][hide]")
 {
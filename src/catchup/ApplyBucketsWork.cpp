@@ -66,6 +66,16 @@ ApplyBucketsWork::getBucket(std::string const& hash)
     return b;
 }
 
+void
+ApplyBucketsWork::rebuildIndexesIfDropped()
+{
+    if (mDroppedIndexes)
+    {
+        BucketApplicator::rebuildIndexes(mApp.getDatabase());
+        mDroppedIndexes = false;
+    }
+}
+
 void
 ApplyBucketsWork::onReset()
 {
@@ -102,11 +112,18 @@ ApplyBucketsWork::onStart()
                                                      oldestLedger);
     }
 
+    if (!mCheckedIndexes && (mApplying || applySnap || applyCurr))
+    {
+        mDroppedIndexes =
+            BucketApplicator::dropIndexesIfEmpty(mApp.getDatabase());
+        mCheckedIndexes = true;
+    }
+
     if (mApplying || applySnap)
     {
         mSnapBucket = getBucket(i.snap);
         mSnapApplicator =
-            make_unique<BucketApplicator>(mApp.getDatabase(), mSnapBucket);
+            make_unique<BucketApplicator>(mApp, mSnapBucket);
         CLOG(DEBUG, "History") << "ApplyBuckets : starting level[" << mLevel
                                << "].snap = " << i.snap;
         mApplying = true;
@@ -116,7 +133,7 @@ ApplyBucketsWork::onStart()
     {
         mCurrBucket = getBucket(i.curr);
         mCurrApplicator =
-            make_unique<BucketApplicator>(mApp.getDatabase(), mCurrBucket);
+            make_unique<BucketApplicator>(mApp, mCurrBucket);
         CLOG(DEBUG, "History") << "ApplyBuckets : starting level[" << mLevel
                                << "].curr = " << i.curr;
         mApplying = true;
@@ -188,6 +205,7 @@ ApplyBucketsWork::onSuccess()
         return WORK_PENDING;
     }
 
+    rebuildIndexesIfDropped();
     CLOG(DEBUG, "History") << "ApplyBuckets : done, restarting merges";
     mApp.getBucketManager().assumeState(mApplyState);
     return WORK_SUCCESS;
@@ -204,6 +222,7 @@ void
 ApplyBucketsWork::onFailureRaise()
 {
     mBucketApplyFailure.Mark();
+    rebuildIndexesIfDropped();
     Work::onFailureRaise();
 }
 }
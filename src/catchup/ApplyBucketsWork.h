@@ -27,6 +27,8 @@ class ApplyBucketsWork : public Work
     const HistoryArchiveState& mApplyState;
 
     bool mApplying;
+    bool mCheckedIndexes{false};
+    bool mDroppedIndexes{false};
     uint32_t mLevel;
     std::shared_ptr<Bucket const> mSnapBucket;
     std::shared_ptr<Bucket const> mCurrBucket;
@@ -39,6 +41,7 @@ class ApplyBucketsWork : public Work
 
     std::shared_ptr<Bucket const> getBucket(std::string const& bucketHash);
     BucketLevel& getBucketLevel(uint32_t level);
+    void rebuildIndexesIfDropped();
 
   public:
     ApplyBucketsWork(
@@ -16,6 +16,7 @@
 #include <map>
 #include <regex>
 #include <sodium.h>
+#include <thread>
 
 using namespace stellar;
 
@@ -112,6 +113,11 @@ TEST_CASE("HMAC test vector", "[crypto]")
     auto v = hmacSha256(k, s);
     REQUIRE(h == v.mac);
     REQUIRE(hmacSha256Verify(v, k, s));
+
+    auto m = HmacSha256::create(k);
+    m->add("The quick brown ");
+    m->add("fox jumps over the lazy dog");
+    REQUIRE(h == m->finish().mac);
 }
 
 TEST_CASE("HKDF test vector", "[crypto]")
@@ -153,6 +159,58 @@ TEST_CASE("sign tests", "[crypto]")
     CHECK(!PubKeyUtils::verifySig(pk, sig, msg));
 }
 
+TEST_CASE("signature verification cache", "[crypto]")
+{
+    auto sk = SecretKey::random();
+    auto pk = sk.getPublicKey();
+    std::string msg = "hello";
+    auto sig = sk.sign(msg);
+    auto badSig = sig;
+    badSig[4] ^= 1;
+
+    PubKeyUtils::clearVerifySigCache();
+    uint64_t hits, misses;
+    PubKeyUtils::flushVerifySigCacheCounts(hits, misses);
+
+    // Catch assertions are not thread-safe, so each thread only counts
+    size_t const nThreads = 4;
+    size_t const nVerifications = 100;
+    std::vector<size_t> verified(nThreads, 0);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < nThreads; ++i)
+    {
+        threads.emplace_back([&, i]() {
+            for (size_t j = 0; j < nVerifications; ++j)
+            {
+                if (PubKeyUtils::verifySig(pk, sig, msg) &&
+                    !PubKeyUtils::verifySig(pk, badSig, msg))
+                {
+                    verified[i]++;
+                }
+            }
+        });
+    }
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+
+    for (auto v : verified)
+    {
+        CHECK(v == nVerifications);
+    }
+    PubKeyUtils::flushVerifySigCacheCounts(hits, misses);
+    CHECK(hits + misses == 2 * nThreads * nVerifications);
+    CHECK(misses >= 2);
+    CHECK(misses <= 2 * nThreads);
+
+    PubKeyUtils::clearVerifySigCache();
+    CHECK(PubKeyUtils::verifySig(pk, sig, msg));
+    PubKeyUtils::flushVerifySigCacheCounts(hits, misses);
+    CHECK(hits == 0);
+    CHECK(misses == 1);
+}
+
 struct SignVerifyTestcase
 {
     SecretKey key;
@@ -28,6 +28,16 @@ class SHA256
 // HMAC-SHA256 (keyed)
 HmacSha256Mac hmacSha256(HmacSha256Key const& key, ByteSlice const& bin);
 
+// HMAC-SHA256 in incremental mode, for inputs made of several buffers.
+class HmacSha256
+{
+  public:
+    static std::unique_ptr<HmacSha256> create(HmacSha256Key const& key);
+    virtual ~HmacSha256(){};
+    virtual void add(ByteSlice const& bin) = 0;
+    virtual HmacSha256Mac finish() = 0;
+};
+
 // Use this rather than HMAC-output ==, to avoid timing leaks.
 bool hmacSha256Verify(HmacSha256Mac const& hmac, HmacSha256Key const& key,
                       ByteSlice const& bin);
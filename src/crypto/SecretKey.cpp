@@ -5,15 +5,19 @@
 #include "crypto/SecretKey.h"
 #include "crypto/Hex.h"
 #include "crypto/KeyUtils.h"
-#include "crypto/SHA.h"
+#include "crypto/ShortHash.h"
 #include "crypto/StrKey.h"
 #include "main/Config.h"
 #include "transactions/SignatureUtils.h"
 #include "util/HashOfHash.h"
 #include "util/lrucache.hpp"
 #include "util/make_unique.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <memory>
 #include <mutex>
+#include <set>
 #include <sodium.h>
 #include <type_traits>
 
@@ -26,24 +30,82 @@ namespace stellar
 // to the state of the process; caching its results centrally
 // makes all signature-verification in the program faster and
 // has no effect on correctness.
+//
+// The cache is split into shards, each with its own lock, so that threads
+// verifying signatures at the same time rarely wait on each other. Entries
+// are found by two SipHashes of the key, signature and message, under
+// secret keys drawn at startup: much cheaper to compute than a SHA256, and
+// just as impossible to make collide on purpose without knowing the keys.
+
+static size_t const kVerifySigCacheShards = 16;
+
+namespace
+{
+struct VerifySigCacheShard
+{
+    std::mutex mMutex;
+    size_t mMaxSize{0};
+    // by the first hash, the second hash and the verification result
+    std::unique_ptr<cache::lru_cache<uint64_t, std::pair<uint64_t, bool>>>
+        mCache;
+};
+
+// Hit and miss counts of one thread, summed by flushVerifySigCacheCounts.
+struct VerifySigCacheCounts
+{
+    std::atomic<uint64_t> mHits{0};
+    std::atomic<uint64_t> mMisses{0};
+
+    VerifySigCacheCounts();
+    ~VerifySigCacheCounts();
+};
+}
 
-static std::mutex gVerifySigCacheMutex;
-static cache::lru_cache<Hash, bool> gVerifySigCache(0xffff);
-static std::unique_ptr<SHA256> gHasher = SHA256::create();
-static uint64_t gVerifyCacheHit = 0;
-static uint64_t gVerifyCacheMiss = 0;
+static std::array<VerifySigCacheShard, kVerifySigCacheShards> gVerifySigCache;
 
-static Hash
+static std::mutex gVerifySigCacheCountsMutex;
+static std::set<VerifySigCacheCounts*> gVerifySigCacheCounts;
+// counts of the threads that have exited since the last flush
+static uint64_t gExitedVerifyCacheHit = 0;
+static uint64_t gExitedVerifyCacheMiss = 0;
+
+VerifySigCacheCounts::VerifySigCacheCounts()
+{
+    std::lock_guard<std::mutex> guard(gVerifySigCacheCountsMutex);
+    gVerifySigCacheCounts.insert(this);
+}
+
+VerifySigCacheCounts::~VerifySigCacheCounts()
+{
+    std::lock_guard<std::mutex> guard(gVerifySigCacheCountsMutex);
+    gExitedVerifyCacheHit += mHits;
+    gExitedVerifyCacheMiss += mMisses;
+    gVerifySigCacheCounts.erase(this);
+}
+
+static VerifySigCacheCounts&
+verifySigCacheCounts()
+{
+    static thread_local VerifySigCacheCounts counts;
+    return counts;
+}
+
+static std::pair<uint64_t, uint64_t>
 verifySigCacheKey(PublicKey const& key, Signature const& signature,
                   ByteSlice const& bin)
 {
     assert(key.type() == PUBLIC_KEY_TYPE_ED25519);
-
-    gHasher->reset();
-    gHasher->add(key.ed25519());
-    gHasher->add(signature);
-    gHasher->add(bin);
-    return gHasher->finish();
+    static ShortHashKey const hashKey1 = randomShortHashKey();
+    static ShortHashKey const hashKey2 = randomShortHashKey();
+
+    // the key and signature have fixed sizes, so this is unambiguous
+    std::vector<uint8_t> buf;
+    buf.reserve(key.ed25519().size() + signature.size() + bin.size());
+    buf.insert(buf.end(), key.ed25519().begin(), key.ed25519().end());
+    buf.insert(buf.end(), signature.begin(), signature.end());
+    buf.insert(buf.end(), bin.begin(), bin.end());
+    ByteSlice all(buf.data(), buf.size());
+    return std::make_pair(shortHash(all, hashKey1), shortHash(all, hashKey2));
 }
 
 SecretKey::SecretKey() : mKeyType(PUBLIC_KEY_TYPE_ED25519)
@@ -198,18 +260,47 @@ SecretKey::fromStrKeySeed(std::string const& strKeySeed)
 void
 PubKeyUtils::clearVerifySigCache()
 {
-    std::lock_guard<std::mutex> guard(gVerifySigCacheMutex);
-    gVerifySigCache.clear();
+    for (auto& shard : gVerifySigCache)
+    {
+        std::lock_guard<std::mutex> guard(shard.mMutex);
+        if (shard.mCache)
+        {
+            shard.mCache->clear();
+        }
+    }
+}
+
+void
+PubKeyUtils::setVerifySigCacheSize(size_t entries)
+{
+    size_t shardSize = std::max<size_t>(1, entries / kVerifySigCacheShards);
+    for (auto& shard : gVerifySigCache)
+    {
+        std::lock_guard<std::mutex> guard(shard.mMutex);
+        // the cache is shared by every Application in the process: only
+        // ever grow it, so that one configured smaller does not shrink (and
+        // drop) what another configured larger
+        if (shardSize > shard.mMaxSize)
+        {
+            shard.mMaxSize = shardSize;
+            shard.mCache.reset();
+        }
+    }
 }
 
 void
 PubKeyUtils::flushVerifySigCacheCounts(uint64_t& hits, uint64_t& misses)
 {
-    std::lock_guard<std::mutex> guard(gVerifySigCacheMutex);
-    hits = gVerifyCacheHit;
-    misses = gVerifyCacheMiss;
-    gVerifyCacheHit = 0;
-    gVerifyCacheMiss = 0;
+    std::lock_guard<std::mutex> guard(gVerifySigCacheCountsMutex);
+    hits = gExitedVerifyCacheHit;
+    misses = gExitedVerifyCacheMiss;
+    gExitedVerifyCacheHit = 0;
+    gExitedVerifyCacheMiss = 0;
+    for (auto counts : gVerifySigCacheCounts)
+    {
+        hits += counts->mHits.exchange(0);
+        misses += counts->mMisses.exchange(0);
+    }
 }
 
 std::string
@@ -290,22 +381,39 @@ PubKeyUtils::verifySig(PublicKey const& key, Signature const& signature,
     }
 
     auto cacheKey = verifySigCacheKey(key, signature, bin);
-
+    auto& shard = gVerifySigCache[cacheKey.second % kVerifySigCacheShards];
+    auto& counts = verifySigCacheCounts();
     {
-        std::lock_guard<std::mutex> guard(gVerifySigCacheMutex);
-        if (gVerifySigCache.exists(cacheKey))
+        std::lock_guard<std::mutex> guard(shard.mMutex);
+        if (!shard.mCache)
         {
-            ++gVerifyCacheHit;
-            return gVerifySigCache.get(cacheKey);
+            shard.mCache = make_unique<
+                cache::lru_cache<uint64_t, std::pair<uint64_t, bool>>>(
+                shard.mMaxSize ? shard.mMaxSize
+                               : DEFAULT_VERIFY_SIG_CACHE_SIZE /
+                                     kVerifySigCacheShards);
+        }
+        if (shard.mCache->exists(cacheKey.first))
+        {
+            auto const& cached = shard.mCache->get(cacheKey.first);
+            if (cached.first == cacheKey.second)
+            {
+                counts.mHits.fetch_add(1, std::memory_order_relaxed);
+                return cached.second;
+            }
         }
     }
 
-    ++gVerifyCacheMiss;
+    counts.mMisses.fetch_add(1, std::memory_order_relaxed);
     bool ok =
         (crypto_sign_verify_detached(signature.data(), bin.data(), bin.size(),
                                      key.ed25519().data()) == 0);
-    std::lock_guard<std::mutex> guard(gVerifySigCacheMutex);
-    gVerifySigCache.put(cacheKey, ok);
+    std::lock_guard<std::mutex> guard(shard.mMutex);
+    // the cache may have been dropped by setVerifySigCacheSize meanwhile
+    if (shard.mCache)
+    {
+        shard.mCache->put(cacheKey.first, std::make_pair(cacheKey.second, ok));
+    }
     return ok;
 }
 
@@ -101,7 +101,14 @@ namespace PubKeyUtils
 bool verifySig(PublicKey const& key, Signature const& signature,
                ByteSlice const& bin);
 
+size_t const DEFAULT_VERIFY_SIG_CACHE_SIZE = 0x10000;
+
 void clearVerifySigCache();
+// The verification cache is process-wide, shared by every Application in the
+// process. Raises the number of verifications it remembers to at least
+// `entries`, clearing it if that grows; never shrinks it.
+void setVerifySigCacheSize(size_t entries);
+// Returns, and resets, the numbers of hits and misses of all threads.
 void flushVerifySigCacheCounts(uint64_t& hits, uint64_t& misses);
 
 PublicKey random();
@@ -0,0 +1,46 @@
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "crypto/ShortHash.h"
+#include <sodium.h>
+#include <stdexcept>
+
+namespace stellar
+{
+
+static_assert(sizeof(ShortHashKey) == crypto_shorthash_KEYBYTES,
+              "Unexpected short hash key length");
+
+static ShortHashKey const kZeroShortHashKey = {{0}};
+
+uint64_t
+shortHash(ByteSlice const& bin)
+{
+    return shortHash(bin, kZeroShortHashKey);
+}
+
+ShortHashKey
+randomShortHashKey()
+{
+    ShortHashKey key;
+    randombytes_buf(key.data(), key.size());
+    return key;
+}
+
+uint64_t
+shortHash(ByteSlice const& bin, ShortHashKey const& key)
+{
+    unsigned char out[crypto_shorthash_BYTES];
+    if (crypto_shorthash(out, bin.data(), bin.size(), key.data()) != 0)
+    {
+        throw std::runtime_error("error from crypto_shorthash");
+    }
+    uint64_t res = 0;
+    for (size_t i = 0; i < sizeof(res); ++i)
+    {
+        res = (res << 8) | out[i];
+    }
+    return res;
+}
+}
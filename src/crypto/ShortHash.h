@@ -0,0 +1,26 @@
+#pragma once
+
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "crypto/ByteSlice.h"
+#include <array>
+#include <cstdint>
+
+namespace stellar
+{
+
+// SipHash-2-4 (libsodium's crypto_shorthash) under a fixed, all-zero key. It is
+// much cheaper than SHA256 and stable across processes, so its output can be
+// persisted; but it offers no resistance to deliberately-chosen collisions, so
+// only use it where a collision costs performance rather than correctness.
+uint64_t shortHash(ByteSlice const& bin);
+
+// SipHash-2-4 under `key`. Under a secret, random key (see
+// randomShortHashKey) its output can't be predicted, so collisions can't be
+// chosen either; such output only means something within this process.
+typedef std::array<unsigned char, 16> ShortHashKey;
+ShortHashKey randomShortHashKey();
+uint64_t shortHash(ByteSlice const& bin, ShortHashKey const& key);
+}
@@ -0,0 +1,336 @@
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "database/BulkTableWriter.h"
+#include "database/Database.h"
+#include "lib/util/format.h"
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+#ifdef USE_POSTGRES
+#include <soci-postgresql.h>
+#endif
+
+namespace stellar
+{
+
+// Number of rows spliced into a single INSERT or DELETE statement.
+static size_t const kRowsPerStatement = 512;
+
+BulkValue::BulkValue(Kind kind, std::string text)
+    : mKind(kind), mText(std::move(text))
+{
+}
+
+BulkValue
+BulkValue::null()
+{
+    return BulkValue(BV_NULL, "");
+}
+
+BulkValue
+BulkValue::text(std::string s)
+{
+    return BulkValue(BV_TEXT, std::move(s));
+}
+
+BulkValue
+BulkValue::integer(int64_t i)
+{
+    return BulkValue(BV_NUMBER, std::to_string(i));
+}
+
+BulkValue
+BulkValue::real(double d)
+{
+    // 17 significant digits round-trip any double exactly.
+    return BulkValue(BV_NUMBER, fmt::format("{:.17g}", d));
+}
+
+void
+BulkValue::appendLiteral(std::string& out) const
+{
+    switch (mKind)
+    {
+    case BV_NULL:
+        out += "NULL";
+        break;
+    case BV_NUMBER:
+        out += mText;
+        break;
+    case BV_TEXT:
+        out += '\'';
+        for (char c : mText)
+        {
+            if (c == '\'')
+            {
+                out += '\'';
+            }
+            out += c;
+        }
+        out += '\'';
+        break;
+    }
+}
+
+void
+BulkValue::appendCopyText(std::string& out) const
+{
+    if (mKind == BV_NULL)
+    {
+        out += "\\N";
+        return;
+    }
+    for (char c : mText)
+    {
+        switch (c)
+        {
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\t':
+            out += "\\t";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        case '\r':
+            out += "\\r";
+            break;
+        default:
+            out += c;
+            break;
+        }
+    }
+}
+
+static std::string
+joinColumns(std::vector<std::string> const& columns)
+{
+    std::string res;
+    for (auto const& c : columns)
+    {
+        if (!res.empty())
+        {
+            res += ',';
+        }
+        res += c;
+    }
+    return res;
+}
+
+static void
+appendTuple(std::string& out, std::vector<BulkValue> const& row)
+{
+    out += '(';
+    for (size_t i = 0; i < row.size(); ++i)
+    {
+        if (i != 0)
+        {
+            out += ',';
+        }
+        row[i].appendLiteral(out);
+    }
+    out += ')';
+}
+
+BulkTableWriter::BulkTableWriter(Database& db, std::string const& table,
+                                 std::vector<std::string> const& columns,
+                                 std::vector<std::string> const& keyColumns,
+                                 std::vector<std::string> const& eraseColumns)
+    : mDb(db)
+    , mTable(table)
+    , mColumns(columns)
+    , mKeyColumns(keyColumns)
+    , mEraseColumns(eraseColumns)
+{
+    assert(!mKeyColumns.empty());
+    assert(!mEraseColumns.empty());
+}
+
+void
+BulkTableWriter::upsert(std::vector<BulkValue> row)
+{
+    assert(row.size() == mColumns.size());
+    mUpserts.emplace_back(std::move(row));
+}
+
+void
+BulkTableWriter::erase(std::vector<BulkValue> key)
+{
+    assert(key.size() == mEraseColumns.size());
+    mErasures.emplace_back(std::move(key));
+}
+
+void
+BulkTableWriter::flush()
+{
+    if (!mErasures.empty())
+    {
+        auto timer = mDb.getDeleteTimer(mTable + "-bulk");
+        flushErasures(mDb.getSession());
+        mErasures.clear();
+    }
+    if (!mUpserts.empty())
+    {
+        auto timer = mDb.getInsertTimer(mTable + "-bulk");
+        flush(mDb.getSession());
+    }
+}
+
+void
+BulkTableWriter::flush(soci::session& sess)
+{
+    if (!mErasures.empty())
+    {
+        flushErasures(sess);
+        mErasures.clear();
+    }
+    if (!mUpserts.empty())
+    {
+#ifdef USE_POSTGRES
+        if (!mDb.isSqlite())
+        {
+            flushUpsertsPostgres(sess);
+        }
+        else
+#endif
+        {
+            flushUpsertsSqlite(sess);
+        }
+        mUpserts.clear();
+    }
+}
+
+void
+BulkTableWriter::flushErasures(soci::session& sess)
+{
+    // DELETE FROM t WHERE k IN ('a','b')
+    // DELETE FROM t WHERE (k1,k2) IN (VALUES ('a','b'),('c','d'))
+    bool single = mEraseColumns.size() == 1;
+    std::string head = "DELETE FROM " + mTable + " WHERE ";
+    head += single ? mEraseColumns[0] + " IN ("
+                   : "(" + joinColumns(mEraseColumns) + ") IN (VALUES ";
+
+    for (size_t i = 0; i < mErasures.size(); i += kRowsPerStatement)
+    {
+        std::string sql = head;
+        size_t end = std::min(mErasures.size(), i + kRowsPerStatement);
+        for (size_t j = i; j < end; ++j)
+        {
+            if (j != i)
+            {
+                sql += ',';
+            }
+            if (single)
+            {
+                mErasures[j][0].appendLiteral(sql);
+            }
+            else
+            {
+                appendTuple(sql, mErasures[j]);
+            }
+        }
+        sql += ')';
+        sess << sql;
+    }
+}
+
+void
+BulkTableWriter::flushUpsertsSqlite(soci::session& sess)
+{
+    // The bundled SQLite predates INSERT ... ON CONFLICT DO UPDATE; since
+    // every row carries all of its columns, replacing it is equivalent.
+    std::string head = "INSERT OR REPLACE INTO " + mTable + " (" +
+                       joinColumns(mColumns) + ") VALUES ";
+
+    for (size_t i = 0; i < mUpserts.size(); i += kRowsPerStatement)
+    {
+        std::string sql = head;
+        size_t end = std::min(mUpserts.size(), i + kRowsPerStatement);
+        for (size_t j = i; j < end; ++j)
+        {
+            if (j != i)
+            {
+                sql += ',';
+            }
+            appendTuple(sql, mUpserts[j]);
+        }
+        sess << sql;
+    }
+}
+
+#ifdef USE_POSTGRES
+void
+BulkTableWriter::flushUpsertsPostgres(soci::session& sess)
+{
+    auto be =
+        dynamic_cast<soci::postgresql_session_backend*>(sess.get_backend());
+    if (!be)
+    {
+        throw std::runtime_error("bulk load requires a PostgreSQL session");
+    }
+    PGconn* conn = be->conn_;
+
+    std::string staging = "bulk_" + mTable;
+    std::string columns = joinColumns(mColumns);
+    sess << "CREATE TEMP TABLE IF NOT EXISTS " << staging
+         << " ON COMMIT DELETE ROWS AS SELECT " << columns << " FROM "
+         << mTable << " WITH NO DATA";
+
+    std::string copy = "COPY " + staging + " (" + columns + ") FROM STDIN";
+    PGresult* res = PQexec(conn, copy.c_str());
+    bool ok = PQresultStatus(res) == PGRES_COPY_IN;
+    PQclear(res);
+    if (!ok)
+    {
+        throw std::runtime_error(std::string("COPY failed: ") +
+                                 PQerrorMessage(conn));
+    }
+
+    std::string buf;
+    for (auto const& row : mUpserts)
+    {
+        for (size_t i = 0; i < row.size(); ++i)
+        {
+            if (i != 0)
+            {
+                buf += '\t';
+            }
+            row[i].appendCopyText(buf);
+        }
+        buf += '\n';
+    }
+    ok = PQputCopyData(conn, buf.data(), static_cast<int>(buf.size())) == 1;
+    ok = PQputCopyEnd(conn, ok ? nullptr : "bulk load aborted") == 1 && ok;
+    while ((res = PQgetResult(conn)) != nullptr)
+    {
+        ok = ok && PQresultStatus(res) == PGRES_COMMAND_OK;
+        PQclear(res);
+    }
+    if (!ok)
+    {
+        throw std::runtime_error(std::string("COPY failed: ") +
+                                 PQerrorMessage(conn));
+    }
+
+    std::vector<std::string> updates;
+    for (auto const& c : mColumns)
+    {
+        if (std::find(mKeyColumns.begin(), mKeyColumns.end(), c) ==
+            mKeyColumns.end())
+        {
+            updates.emplace_back(c + "=excluded." + c);
+        }
+    }
+    std::string conflict =
+        updates.empty() ? "DO NOTHING" : "DO UPDATE SET " + joinColumns(updates);
+    sess << "INSERT INTO " << mTable << " (" << columns << ") SELECT "
+         << columns << " FROM " << staging << " ON CONFLICT ("
+         << joinColumns(mKeyColumns) << ") " << conflict;
+    sess << "DELETE FROM " << staging;
+}
+#endif
+}
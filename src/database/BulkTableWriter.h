@@ -0,0 +1,111 @@
+#pragma once
+
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/NonCopyable.h"
+#include "util/SociNoWarnings.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace stellar
+{
+
+class Database;
+
+/**
+ * A single column value, as accumulated by BulkTableWriter. Values are kept in
+ * their text form so that they can be spliced into a multi-row statement
+ * (quoted, if text) or streamed to a COPY (escaped) without rebinding.
+ */
+class BulkValue
+{
+    enum Kind
+    {
+        BV_NULL,
+        BV_TEXT,
+        BV_NUMBER
+    };
+
+    Kind mKind;
+    std::string mText;
+
+    BulkValue(Kind kind, std::string text);
+
+  public:
+    static BulkValue null();
+    static BulkValue text(std::string s);
+    static BulkValue integer(int64_t i);
+    static BulkValue real(double d);
+
+    // Append this value as an SQL literal.
+    void appendLiteral(std::string& out) const;
+
+    // Append this value in PostgreSQL's COPY text format.
+    void appendCopyText(std::string& out) const;
+};
+
+/**
+ * Helper for writing many rows to a single table at once, used to bulk-load
+ * ledger entries from buckets. Rows are accumulated by `upsert` (insert, or
+ * replace a row with the same key) and `erase` (delete all rows matching a
+ * key), and are only sent to the database by `flush`, which performs all the
+ * erasures before all the upserts.
+ *
+ * On SQLite, rows are written with multi-row INSERT OR REPLACE and DELETE
+ * statements. On PostgreSQL, upserted rows are streamed with COPY into a
+ * temporary staging table and then merged into the target table with a single
+ * INSERT ... ON CONFLICT DO UPDATE.
+ *
+ * Callers are responsible for running `flush` in a transaction, and for not
+ * upserting the same key twice between flushes.
+ */
+class BulkTableWriter : public NonMovableOrCopyable
+{
+    Database& mDb;
+    std::string const mTable;
+    std::vector<std::string> const mColumns;
+    std::vector<std::string> const mKeyColumns;
+    std::vector<std::string> const mEraseColumns;
+
+    std::vector<std::vector<BulkValue>> mUpserts;
+    std::vector<std::vector<BulkValue>> mErasures;
+
+    void flushErasures(soci::session& sess);
+    void flushUpsertsSqlite(soci::session& sess);
+#ifdef USE_POSTGRES
+    void flushUpsertsPostgres(soci::session& sess);
+#endif
+
+  public:
+    // `keyColumns` identify a row for the purpose of upserts and must be the
+    // table's primary key; `eraseColumns` are the columns `erase` matches on,
+    // and may be a prefix of the key (to delete a group of rows at once).
+    BulkTableWriter(Database& db, std::string const& table,
+                    std::vector<std::string> const& columns,
+                    std::vector<std::string> const& keyColumns,
+                    std::vector<std::string> const& eraseColumns);
+
+    // Precondition: row.size() == number of columns.
+    void upsert(std::vector<BulkValue> row);
+
+    // Precondition: key.size() == number of erase columns.
+    void erase(std::vector<BulkValue> key);
+
+    size_t
+    size() const
+    {
+        return mUpserts.size() + mErasures.size();
+    }
+
+    // Write all accumulated rows over the Database's main session.
+    void flush();
+
+    // Write all accumulated rows over `sess`, which must be connected to the
+    // same database. This records no metrics, so can be called from a worker
+    // thread with a pooled session.
+    void flush(soci::session& sess);
+};
+}
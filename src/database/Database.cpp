@@ -55,6 +55,9 @@ bool Database::gDriversRegistered = false;
 
 static unsigned long const SCHEMA_VERSION = 5;
 
+// Approximate memory budget of the LedgerEntry cache.
+static size_t const kEntryCacheBytes = 32 * 1024 * 1024;
+
 static void
 setSerializable(soci::session& sess)
 {
@@ -81,7 +84,8 @@ Database::Database(Application& app)
           app.getMetrics().NewMeter({"database", "query", "exec"}, "query"))
     , mStatementsSize(
           app.getMetrics().NewCounter({"database", "memory", "statements"}))
-    , mEntryCache(4096)
+    , mEntryCache(app.getMetrics(), kEntryCacheBytes)
+    , mOrderBook(app.getConfig().ORDER_BOOK_MAX_OFFERS)
     , mExcludedQueryTime(0)
     , mExcludedTotalTime(0)
     , mLastIdleQueryTime(0)
@@ -167,6 +171,11 @@ Database::upgradeToCurrentSchema()
         putSchemaVersion(vers);
     }
     assert(vers == SCHEMA_VERSION);
+
+    // applying buckets drops these indexes while it bulk-loads; if it was
+    // interrupted, they were never rebuilt
+    AccountFrame::createSecondaryIndexes(*this);
+    OfferFrame::createSecondaryIndexes(*this);
 }
 
 void
@@ -284,6 +293,8 @@ void
 Database::initialize()
 {
     clearPreparedStatementCache();
+    mEntryCache.clear();
+    mOrderBook.clear();
     // normally you do not want to touch this section as
     // schema updates are done in applySchemaUpgrade
 
@@ -341,12 +352,18 @@ Database::getPool()
     return *mPool;
 }
 
-cache::lru_cache<std::string, std::shared_ptr<LedgerEntry const>>&
+EntryCache&
 Database::getEntryCache()
 {
     return mEntryCache;
 }
 
+OrderBook&
+Database::getOrderBook()
+{
+    return mOrderBook;
+}
+
 class SQLLogContext : NonCopyable
 {
     std::string mName;
@@ -404,6 +421,16 @@ Database::getPreparedStatement(std::string const& query)
     return sc;
 }
 
+StatementContext
+Database::getUncachedStatement(std::string const& query)
+{
+    auto p = std::make_shared<soci::statement>(mSession);
+    p->alloc();
+    p->prepare(query);
+    StatementContext sc(p);
+    return sc;
+}
+
 std::shared_ptr<SQLLogContext>
 Database::captureAndLogSQL(std::string contextName)
 {
@@ -4,12 +4,14 @@
 // under the Apache License, Version 2.0. See the COPYING file at the root
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
+#include "database/EntryCache.h"
+#include "ledger/OrderBook.h"
 #include "medida/timer_context.h"
 #include "overlay/StellarXDR.h"
 #include "util/NonCopyable.h"
 #include "util/SociNoWarnings.h"
 #include "util/Timer.h"
-#include "util/lrucache.hpp"
+#include <map>
 #include <set>
 #include <string>
 
@@ -92,8 +94,8 @@ class Database : NonMovableOrCopyable
     std::map<std::string, std::shared_ptr<soci::statement>> mStatements;
     medida::Counter& mStatementsSize;
 
-    cache::lru_cache<std::string, std::shared_ptr<LedgerEntry const>>
-        mEntryCache;
+    EntryCache mEntryCache;
+    OrderBook mOrderBook;
 
     // Helpers for maintaining the total query time and calculating
     // idle percentage.
@@ -142,6 +144,10 @@ class Database : NonMovableOrCopyable
     // when the statement context is destroyed.
     StatementContext getPreparedStatement(std::string const& query);
 
+    // As above, but for a one-off query (such as one with an IN list of
+    // varying length) that should not be kept in the statement cache.
+    StatementContext getUncachedStatement(std::string const& query);
+
     // Purge all cached prepared statements, closing their handles with the
     // database.
     void clearPreparedStatementCache();
@@ -192,9 +198,11 @@ class Database : NonMovableOrCopyable
     // Access the LedgerEntry cache. Note: clients are responsible for
     // invalidating entries in this cache as they perform statements
     // against the database. It's kept here only for ease of access.
-    typedef cache::lru_cache<std::string, std::shared_ptr<LedgerEntry const>>
-        EntryCache;
     EntryCache& getEntryCache();
+
+    // Access the in-memory order book, which (like the LedgerEntry cache)
+    // clients are responsible for keeping in sync with the offers table.
+    OrderBook& getOrderBook();
 };
 
 class DBTimeExcluder : NonCopyable
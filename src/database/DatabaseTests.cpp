@@ -5,9 +5,15 @@
 #include "util/asio.h"
 #include "crypto/Hex.h"
 #include "database/Database.h"
+#include "database/EntryCache.h"
+#include "ledger/AccountFrame.h"
+#include "ledger/EntryFrame.h"
+#include "ledger/LedgerTestUtils.h"
+#include "ledger/OfferFrame.h"
 #include "lib/catch.hpp"
 #include "main/Application.h"
 #include "main/Config.h"
+#include "medida/metrics_registry.h"
 #include "test/TestUtils.h"
 #include "test/test.h"
 #include "util/Logging.h"
@@ -340,3 +346,80 @@ TEST_CASE("schema test", "[db]")
     auto av = db.getAppSchemaVersion();
     REQUIRE(dbv == av);
 }
+
+TEST_CASE("secondary indexes recreated on start", "[db]")
+{
+    Config const& cfg = getTestConfig(0, Config::TESTDB_IN_MEMORY_SQLITE);
+
+    VirtualClock clock;
+    Application::pointer app = createTestApplication(clock, cfg);
+
+    // as left by bucket-apply interrupted before rebuilding them
+    auto& db = app->getDatabase();
+    AccountFrame::dropSecondaryIndexes(db);
+    OfferFrame::dropSecondaryIndexes(db);
+
+    app->start();
+
+    // dropping an index that does not exist fails
+    for (auto index : {"signersaccount", "accountbalances",
+                       "sellingissuerindex", "buyingissuerindex", "priceindex"})
+    {
+        REQUIRE_NOTHROW(db.getSession() << "DROP INDEX " << index << ";");
+    }
+}
+
+TEST_CASE("entry cache", "[db][entrycache]")
+{
+    medida::MetricsRegistry metrics;
+    auto entries = LedgerTestUtils::generateValidLedgerEntries(1000);
+    size_t const maxBytes = 64 * 1024;
+    EntryCache cache(metrics, maxBytes);
+
+    auto hot = std::make_shared<LedgerEntry const>(entries[0]);
+    auto hotKey = LedgerEntryKey(*hot);
+
+    SECTION("absent entries are cached as null")
+    {
+        REQUIRE(!cache.exists(hotKey));
+        cache.put(hotKey, nullptr);
+        REQUIRE(cache.exists(hotKey));
+        REQUIRE(!cache.get(hotKey));
+        cache.erase(hotKey);
+        REQUIRE(!cache.exists(hotKey));
+        REQUIRE(cache.size() == 0);
+        REQUIRE(cache.bytes() == 0);
+    }
+
+    SECTION("hot entries survive a scan")
+    {
+        cache.put(hotKey, hot);
+        REQUIRE(cache.get(hotKey) == hot);
+        for (size_t i = 1; i < entries.size(); ++i)
+        {
+            auto e = std::make_shared<LedgerEntry const>(entries[i]);
+            cache.put(LedgerEntryKey(*e), e);
+            REQUIRE(cache.bytes() <= maxBytes);
+        }
+        REQUIRE(cache.size() < entries.size());
+        REQUIRE(cache.exists(hotKey));
+        REQUIRE(cache.get(hotKey) == hot);
+        REQUIRE(!cache.exists(LedgerEntryKey(entries[1])));
+    }
+
+    SECTION("erase_if")
+    {
+        for (auto const& e : entries)
+        {
+            cache.put(LedgerEntryKey(e), std::make_shared<LedgerEntry const>(e));
+        }
+        cache.erase_if([](std::shared_ptr<LedgerEntry const> le) {
+            return le && le->data.type() == ACCOUNT;
+        });
+        for (auto const& e : entries)
+        {
+            auto k = LedgerEntryKey(e);
+            REQUIRE((e.data.type() != ACCOUNT || !cache.exists(k)));
+        }
+    }
+}
@@ -0,0 +1,205 @@
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "database/EntryCache.h"
+#include "crypto/ShortHash.h"
+#include "medida/meter.h"
+#include "medida/metrics_registry.h"
+#include "xdrpp/marshal.h"
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+namespace stellar
+{
+
+using xdr::operator==;
+
+// Share of the cache's bytes the protected segment may hold.
+static size_t const kProtectedPercent = 80;
+
+// Rough per-entry overhead of the lists, the index and the shared_ptr.
+static size_t const kNodeOverhead = 128;
+
+static uint64_t
+hashKey(LedgerKey const& key)
+{
+    // The largest LedgerKey (a DATA key with a 64-byte name) is 108 bytes;
+    // xdr_put writes whole 32-bit words, so the buffer is aligned for them.
+    alignas(4) std::array<uint8_t, 128> buf;
+    size_t sz = xdr::xdr_size(key);
+    if (sz > buf.size())
+    {
+        return shortHash(xdr::xdr_to_opaque(key));
+    }
+    xdr::xdr_put p(buf.data(), buf.data() + sz);
+    xdr_argpack_archive(p, key);
+    return shortHash(ByteSlice(buf.data(), sz));
+}
+
+EntryCache::EntryCache(medida::MetricsRegistry& metrics, size_t maxBytes)
+    : mMaxBytes(maxBytes), mMaxProtectedBytes(maxBytes * kProtectedPercent / 100)
+{
+    for (auto t : xdr::xdr_traits<LedgerEntryType>::enum_values())
+    {
+        std::string name = xdr::xdr_traits<LedgerEntryType>::enum_name(
+            static_cast<LedgerEntryType>(t));
+        mHits.resize(std::max<size_t>(mHits.size(), t + 1), nullptr);
+        mNegativeHits.resize(std::max<size_t>(mNegativeHits.size(), t + 1),
+                             nullptr);
+        mMisses.resize(std::max<size_t>(mMisses.size(), t + 1), nullptr);
+        mHits[t] = &metrics.NewMeter({"entry-cache", name, "hit"}, "lookup");
+        mNegativeHits[t] =
+            &metrics.NewMeter({"entry-cache", name, "negative-hit"}, "lookup");
+        mMisses[t] = &metrics.NewMeter({"entry-cache", name, "miss"}, "lookup");
+    }
+}
+
+EntryCache::NodeList::iterator
+EntryCache::find(LedgerKey const& key, uint64_t hash)
+{
+    auto i = mIndex.find(hash);
+    if (i == mIndex.end() || !(i->second->mKey == key))
+    {
+        return mProbation.end();
+    }
+    return i->second;
+}
+
+void
+EntryCache::unlink(NodeList::iterator it)
+{
+    mIndex.erase(it->mHash);
+    if (it->mProtected)
+    {
+        mProtectedBytes -= it->mBytes;
+        mProtected.erase(it);
+    }
+    else
+    {
+        mProbationBytes -= it->mBytes;
+        mProbation.erase(it);
+    }
+}
+
+void
+EntryCache::shrink()
+{
+    while (mProtectedBytes > mMaxProtectedBytes)
+    {
+        // Demote the protected segment's least-recently-used entry; it has
+        // one more chance to be looked up before it's evicted.
+        auto last = std::prev(mProtected.end());
+        last->mProtected = false;
+        mProtectedBytes -= last->mBytes;
+        mProbationBytes += last->mBytes;
+        mProbation.splice(mProbation.begin(), mProtected, last);
+    }
+    while (mProbationBytes + mProtectedBytes > mMaxBytes && !mProbation.empty())
+    {
+        unlink(std::prev(mProbation.end()));
+    }
+}
+
+bool
+EntryCache::exists(LedgerKey const& key, bool recordMetrics)
+{
+    auto it = find(key, hashKey(key));
+    bool found = it != mProbation.end();
+    auto t = static_cast<size_t>(key.type());
+    if (recordMetrics && t < mHits.size() && mHits[t])
+    {
+        (found ? mHits[t] : mMisses[t])->Mark();
+        if (found && !it->mEntry)
+        {
+            mNegativeHits[t]->Mark();
+        }
+    }
+    return found;
+}
+
+std::shared_ptr<LedgerEntry const>
+EntryCache::get(LedgerKey const& key)
+{
+    auto it = find(key, hashKey(key));
+    if (it == mProbation.end())
+    {
+        throw std::range_error("There is no such key in cache");
+    }
+    auto entry = it->mEntry;
+    if (it->mProtected)
+    {
+        mProtected.splice(mProtected.begin(), mProtected, it);
+    }
+    else
+    {
+        // A second use earns an entry a place in the protected segment.
+        it->mProtected = true;
+        mProbationBytes -= it->mBytes;
+        mProtectedBytes += it->mBytes;
+        mProtected.splice(mProtected.begin(), mProbation, it);
+        shrink();
+    }
+    return entry;
+}
+
+void
+EntryCache::put(LedgerKey const& key, std::shared_ptr<LedgerEntry const> entry)
+{
+    uint64_t hash = hashKey(key);
+    auto i = mIndex.find(hash);
+    bool wasProtected = false;
+    if (i != mIndex.end())
+    {
+        // Either an update of the same key, which keeps its standing, or
+        // (very rarely) a hash collision, which just replaces the old key.
+        wasProtected = i->second->mProtected && i->second->mKey == key;
+        unlink(i->second);
+    }
+
+    size_t bytes = kNodeOverhead + (entry ? xdr::xdr_size(*entry) : 0);
+    NodeList& list = wasProtected ? mProtected : mProbation;
+    list.push_front(Node{hash, key, std::move(entry), bytes, wasProtected});
+    (wasProtected ? mProtectedBytes : mProbationBytes) += bytes;
+    mIndex.emplace(hash, list.begin());
+    shrink();
+}
+
+void
+EntryCache::erase(LedgerKey const& key)
+{
+    auto it = find(key, hashKey(key));
+    if (it != mProbation.end())
+    {
+        unlink(it);
+    }
+}
+
+void
+EntryCache::erase_if(
+    std::function<bool(std::shared_ptr<LedgerEntry const>)> pred)
+{
+    for (auto* list : {&mProbation, &mProtected})
+    {
+        for (auto it = list->begin(); it != list->end();)
+        {
+            auto j = it++;
+            if (pred(j->mEntry))
+            {
+                unlink(j);
+            }
+        }
+    }
+}
+
+void
+EntryCache::clear()
+{
+    mIndex.clear();
+    mProbation.clear();
+    mProtected.clear();
+    mProbationBytes = 0;
+    mProtectedBytes = 0;
+}
+}
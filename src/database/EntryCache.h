@@ -0,0 +1,108 @@
+#pragma once
+
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "overlay/StellarXDR.h"
+#include "util/NonCopyable.h"
+#include <functional>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace medida
+{
+class Meter;
+class MetricsRegistry;
+}
+
+namespace stellar
+{
+
+/**
+ * Cache of LedgerEntries (or of their absence, as a null pointer) by
+ * LedgerKey, bounded by the approximate number of bytes it holds.
+ *
+ * Entries are found by a 64-bit short hash of the key's XDR encoding, so no
+ * strings are built on lookup; the full key is kept alongside each entry to
+ * rule out hash collisions.
+ *
+ * Eviction is segmented-LRU, a simplified 2Q: entries are admitted to a
+ * probationary segment and only move to a protected segment when they are
+ * looked up again. Entries evicted from the protected segment are demoted to
+ * the head of the probationary one, and only the probationary segment's tail
+ * is ever dropped from the cache. A scan that touches each entry once (bucket
+ * apply, inflation, checkdb) therefore churns only the probationary segment
+ * and leaves the hot set alone.
+ *
+ * Caching absence lets lookups of missing keys (payments to unfunded
+ * accounts, ChangeTrust and ManageData on new entries) skip the database; such
+ * hits are also counted separately, as "negative-hit". Callers must flush a
+ * key whenever they create its entry, as for any other change.
+ */
+class EntryCache : NonMovableOrCopyable
+{
+    struct Node
+    {
+        uint64_t mHash;
+        LedgerKey mKey;
+        std::shared_ptr<LedgerEntry const> mEntry;
+        size_t mBytes;
+        bool mProtected;
+    };
+    typedef std::list<Node> NodeList;
+
+    size_t const mMaxBytes;
+    size_t const mMaxProtectedBytes;
+    size_t mProbationBytes{0};
+    size_t mProtectedBytes{0};
+    NodeList mProbation;
+    NodeList mProtected;
+    std::unordered_map<uint64_t, NodeList::iterator> mIndex;
+
+    // Indexed by LedgerEntryType.
+    std::vector<medida::Meter*> mHits;
+    std::vector<medida::Meter*> mNegativeHits;
+    std::vector<medida::Meter*> mMisses;
+
+    NodeList::iterator find(LedgerKey const& key, uint64_t hash);
+    void unlink(NodeList::iterator it);
+    void shrink();
+
+  public:
+    EntryCache(medida::MetricsRegistry& metrics, size_t maxBytes);
+
+    // Returns whether `key` is cached, either as an entry or as known to be
+    // absent, and (unless told not to) counts a hit or miss for the key's
+    // type.
+    bool exists(LedgerKey const& key, bool recordMetrics = true);
+
+    // Precondition: exists(key). Returns the cached value, which may be null,
+    // and marks it as recently used.
+    std::shared_ptr<LedgerEntry const> get(LedgerKey const& key);
+
+    void put(LedgerKey const& key, std::shared_ptr<LedgerEntry const> entry);
+
+    void erase(LedgerKey const& key);
+
+    // Erase every cached value for which `pred` returns true.
+    void
+    erase_if(std::function<bool(std::shared_ptr<LedgerEntry const>)> pred);
+
+    void clear();
+
+    size_t
+    size() const
+    {
+        return mIndex.size();
+    }
+
+    size_t
+    bytes() const
+    {
+        return mProbationBytes + mProtectedBytes;
+    }
+};
+}
@@ -0,0 +1,159 @@
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/asio.h"
+#include "herder/EnvelopeVerifier.h"
+#include "crypto/SecretKey.h"
+#include "main/Application.h"
+#include "main/Config.h"
+#include "util/Logging.h"
+#include "util/Timer.h"
+#include "util/make_unique.h"
+#include "xdrpp/marshal.h"
+
+#include "medida/meter.h"
+#include "medida/metrics_registry.h"
+#include <cassert>
+
+namespace stellar
+{
+
+EnvelopeVerifier::EnvelopeVerifier(
+    Application& app, std::function<void(SCPEnvelope const&)> deliver,
+    size_t maxPerNode, size_t maxPending)
+    : mApp(app)
+    , mDeliver(deliver)
+    , mMaxPerNode(maxPerNode)
+    , mMaxPending(maxPending)
+    , mDropped(
+          app.getMetrics().NewMeter({"scp", "envelope", "dropped"}, "envelope"))
+    , mVerified(app.getMetrics().NewMeter({"scp", "envelope", "verified"},
+                                          "envelope"))
+{
+    if (mApp.getClock().getMode() == VirtualClock::REAL_TIME)
+    {
+        mWork = make_unique<asio::io_service::work>(mVerifyService);
+        mThread = std::thread([this]() { mVerifyService.run(); });
+    }
+}
+
+EnvelopeVerifier::~EnvelopeVerifier()
+{
+    // checks not started yet are abandoned, their envelopes would not be
+    // delivered anyway
+    mWork.reset();
+    mVerifyService.stop();
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+}
+
+EnvelopeVerifier::EntryPtr
+EnvelopeVerifier::popOldest(NodeID const& nodeID)
+{
+    auto it = mByNode.find(nodeID);
+    assert(it != mByNode.end());
+    auto entry = it->second.front();
+    it->second.pop_front();
+    if (it->second.empty())
+    {
+        mByNode.erase(it);
+    }
+    mPending--;
+    return entry;
+}
+
+void
+EnvelopeVerifier::dropOldest(NodeID const& nodeID)
+{
+    popOldest(nodeID)->mState = Entry::DROPPED;
+    mDropped.Mark();
+}
+
+void
+EnvelopeVerifier::add(SCPEnvelope const& envelope)
+{
+    if (mApp.getClock().getMode() != VirtualClock::REAL_TIME)
+    {
+        mDeliver(envelope);
+        return;
+    }
+
+    auto const& nodeID = envelope.statement.nodeID;
+    auto fromNode = mByNode.find(nodeID);
+    if (fromNode != mByNode.end() && fromNode->second.size() >= mMaxPerNode)
+    {
+        dropOldest(nodeID);
+    }
+    if (mPending >= mMaxPending)
+    {
+        // the oldest entry not dropped is the oldest of its node
+        for (auto const& e : mQueue)
+        {
+            if (e->mState != Entry::DROPPED)
+            {
+                dropOldest(e->mEnvelope.statement.nodeID);
+                break;
+            }
+        }
+    }
+
+    auto entry = std::make_shared<Entry>(envelope);
+    mQueue.emplace_back(entry);
+    mByNode[nodeID].emplace_back(entry);
+    mPending++;
+
+    // the verifying thread only reads the envelope, which is never modified
+    std::weak_ptr<EnvelopeVerifier> weak = shared_from_this();
+    auto networkID = mApp.getNetworkID();
+    auto& app = mApp;
+    mVerifyService.post([weak, entry, networkID, &app]() {
+        auto const& env = entry->mEnvelope;
+        bool valid = PubKeyUtils::verifySig(
+            env.statement.nodeID, env.signature,
+            xdr::xdr_to_opaque(networkID, ENVELOPE_TYPE_SCP, env.statement));
+        app.getClock().getIOService().post([weak, entry, valid]() {
+            auto self = weak.lock();
+            if (self)
+            {
+                self->verified(entry, valid);
+            }
+        });
+    });
+}
+
+void
+EnvelopeVerifier::verified(EntryPtr entry, bool valid)
+{
+    if (entry->mState == Entry::PENDING)
+    {
+        entry->mState = valid ? Entry::VALID : Entry::INVALID;
+    }
+
+    while (!mQueue.empty() && mQueue.front()->mState != Entry::PENDING)
+    {
+        auto front = mQueue.front();
+        mQueue.pop_front();
+        if (front->mState == Entry::DROPPED)
+        {
+            continue;
+        }
+
+        popOldest(front->mEnvelope.statement.nodeID);
+        if (front->mState == Entry::VALID)
+        {
+            mVerified.Mark();
+            mDeliver(front->mEnvelope);
+        }
+        else
+        {
+            CLOG(DEBUG, "Herder")
+                << "Dropping SCP envelope with an invalid signature from "
+                << mApp.getConfig().toShortString(
+                       front->mEnvelope.statement.nodeID);
+        }
+    }
+}
+}
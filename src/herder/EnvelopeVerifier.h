@@ -0,0 +1,102 @@
+#pragma once
+
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/asio.h"
+#include "overlay/StellarXDR.h"
+#include "util/NonCopyable.h"
+#include <deque>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+
+namespace medida
+{
+class Meter;
+}
+
+namespace stellar
+{
+class Application;
+
+/**
+ * Checks the signatures of the SCP envelopes received from peers on a thread
+ * of its own, and hands those correctly signed to `deliver` on the main
+ * thread, in the order they arrived ("scp.envelope.verified"). The worker
+ * threads are not used, as envelopes would then wait behind bucket merges.
+ * SCP checks them again when it receives them, which is then a hit in the
+ * signature verification cache.
+ *
+ * At most `maxPerNode` envelopes of any one node, and `maxPending` overall,
+ * are waiting to be delivered; past that, the oldest envelope of that node,
+ * or the oldest overall, is dropped ("scp.envelope.dropped"), so that a flood
+ * of stale envelopes cannot build up a backlog.
+ *
+ * With a virtual clock, which skips time forward whenever the main thread is
+ * idle, envelopes are delivered right away instead.
+ */
+class EnvelopeVerifier : public std::enable_shared_from_this<EnvelopeVerifier>,
+                         NonMovableOrCopyable
+{
+    struct Entry
+    {
+        enum State
+        {
+            PENDING,
+            VALID,
+            INVALID,
+            DROPPED
+        };
+
+        SCPEnvelope const mEnvelope;
+        State mState{PENDING};
+
+        explicit Entry(SCPEnvelope const& envelope) : mEnvelope(envelope)
+        {
+        }
+    };
+    typedef std::shared_ptr<Entry> EntryPtr;
+
+    Application& mApp;
+    std::function<void(SCPEnvelope const&)> mDeliver;
+    size_t const mMaxPerNode;
+    size_t const mMaxPending;
+
+    // every entry not delivered yet, in arrival order, and those not dropped
+    // by node
+    std::deque<EntryPtr> mQueue;
+    std::unordered_map<NodeID, std::deque<EntryPtr>> mByNode;
+    size_t mPending{0};
+
+    medida::Meter& mDropped;
+    medida::Meter& mVerified;
+
+    // only run with a real-time clock
+    asio::io_service mVerifyService;
+    std::unique_ptr<asio::io_service::work> mWork;
+    std::thread mThread;
+
+    // removes the oldest pending entry of a node
+    EntryPtr popOldest(NodeID const& nodeID);
+    void dropOldest(NodeID const& nodeID);
+    void verified(EntryPtr entry, bool valid);
+
+  public:
+    EnvelopeVerifier(Application& app,
+                     std::function<void(SCPEnvelope const&)> deliver,
+                     size_t maxPerNode, size_t maxPending);
+    ~EnvelopeVerifier();
+
+    void add(SCPEnvelope const& envelope);
+
+    // number of envelopes waiting to be delivered
+    size_t
+    size() const
+    {
+        return mPending;
+    }
+};
+}
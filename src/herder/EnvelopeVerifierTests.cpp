@@ -0,0 +1,156 @@
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/asio.h"
+#include "herder/EnvelopeVerifier.h"
+#include "crypto/SHA.h"
+#include "crypto/SecretKey.h"
+#include "herder/Herder.h"
+#include "lib/catch.hpp"
+#include "main/Application.h"
+#include "simulation/Topologies.h"
+#include "test/TestUtils.h"
+#include "test/test.h"
+#include "util/Timer.h"
+#include "xdrpp/marshal.h"
+
+#include "medida/meter.h"
+#include "medida/metrics_registry.h"
+#include <future>
+
+using namespace stellar;
+using xdr::operator==;
+
+TEST_CASE("envelope verifier", "[herder][envelopeverifier]")
+{
+    VirtualClock clock(VirtualClock::REAL_TIME);
+    Application::pointer app = createTestApplication(clock, getTestConfig());
+
+    auto makeEnvelope = [&](SecretKey const& key, uint64 slotIndex) {
+        SCPEnvelope envelope;
+        auto& st = envelope.statement;
+        st.nodeID = key.getPublicKey();
+        st.slotIndex = slotIndex;
+        st.pledges.type(SCP_ST_NOMINATE);
+        envelope.signature = key.sign(
+            xdr::xdr_to_opaque(app->getNetworkID(), ENVELOPE_TYPE_SCP, st));
+        return envelope;
+    };
+
+    auto a = SecretKey::fromSeed(sha256("A"));
+    auto b = SecretKey::fromSeed(sha256("B"));
+    auto c = SecretKey::fromSeed(sha256("C"));
+
+    std::vector<SCPEnvelope> delivered;
+    auto deliver = [&](SCPEnvelope const& e) { delivered.push_back(e); };
+    auto& dropped =
+        app->getMetrics().NewMeter({"scp", "envelope", "dropped"}, "envelope");
+
+    auto drain = [&](EnvelopeVerifier const& verifier,
+                     std::vector<SCPEnvelope> const& expected) {
+        auto deadline = clock.now() + std::chrono::seconds(10);
+        while (verifier.size() != 0 && clock.now() < deadline)
+        {
+            clock.crank(false);
+        }
+        REQUIRE(verifier.size() == 0);
+        REQUIRE(delivered.size() == expected.size());
+        for (size_t i = 0; i < expected.size(); i++)
+        {
+            REQUIRE(delivered[i] == expected[i]);
+        }
+    };
+
+    SECTION("in arrival order, without invalid ones and old ones of a node")
+    {
+        auto verifier =
+            std::make_shared<EnvelopeVerifier>(*app, deliver, 2, 100);
+        auto a1 = makeEnvelope(a, 1);
+        auto b1 = makeEnvelope(b, 1);
+        b1.signature.back() ^= 1;
+        auto a2 = makeEnvelope(a, 2);
+        auto c1 = makeEnvelope(c, 1);
+        auto a3 = makeEnvelope(a, 3);
+        for (auto const& e : {a1, b1, a2, c1, a3})
+        {
+            verifier->add(e);
+        }
+        REQUIRE(verifier->size() == 4);
+        REQUIRE(dropped.count() == 1);
+
+        drain(*verifier, {a2, c1, a3});
+    }
+
+    SECTION("oldest dropped when full")
+    {
+        auto verifier =
+            std::make_shared<EnvelopeVerifier>(*app, deliver, 100, 2);
+        auto a1 = makeEnvelope(a, 1);
+        auto b1 = makeEnvelope(b, 1);
+        auto c1 = makeEnvelope(c, 1);
+        for (auto const& e : {a1, b1, c1})
+        {
+            verifier->add(e);
+        }
+        REQUIRE(verifier->size() == 2);
+        REQUIRE(dropped.count() == 1);
+
+        drain(*verifier, {b1, c1});
+    }
+
+    SECTION("while the worker threads are busy")
+    {
+        // as when they are all merging buckets
+        std::promise<void> release;
+        std::shared_future<void> released = release.get_future().share();
+        for (unsigned i = 0; i < std::thread::hardware_concurrency(); i++)
+        {
+            app->getWorkerIOService().post([released]() { released.wait(); });
+        }
+
+        auto verifier =
+            std::make_shared<EnvelopeVerifier>(*app, deliver, 100, 100);
+        auto a1 = makeEnvelope(a, 1);
+        auto b1 = makeEnvelope(b, 1);
+        verifier->add(a1);
+        verifier->add(b1);
+
+        auto deadline = clock.now() + std::chrono::seconds(10);
+        while (verifier->size() != 0 && clock.now() < deadline)
+        {
+            clock.crank(false);
+        }
+        auto pending = verifier->size();
+        release.set_value();
+
+        REQUIRE(pending == 0);
+        drain(*verifier, {a1, b1});
+    }
+}
+
+TEST_CASE("envelope verifier with a real-time clock",
+          "[herder][envelopeverifier][simulation]")
+{
+    Hash networkID = sha256(getTestConfig().NETWORK_PASSPHRASE);
+    auto simulation =
+        Topologies::core(3, 1.0, Simulation::OVER_TCP, networkID);
+    simulation->startAllNodes();
+
+    int nLedgers = 3;
+    simulation->crankUntil(
+        [&simulation, nLedgers]() {
+            return simulation->haveAllExternalized(nLedgers + 1, 1);
+        },
+        2 * nLedgers * Herder::EXP_LEDGER_TIMESPAN_SECONDS, true);
+    REQUIRE(simulation->haveAllExternalized(nLedgers + 1, 1));
+
+    // all three nodes are needed for a quorum, so each has received the
+    // envelopes of the others from the network, through its verifier
+    for (auto const& node : simulation->getNodes())
+    {
+        auto& verified = node->getMetrics().NewMeter(
+            {"scp", "envelope", "verified"}, "envelope");
+        REQUIRE(verified.count() != 0);
+    }
+}
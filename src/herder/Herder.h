@@ -18,6 +18,7 @@ namespace stellar
 {
 class Application;
 class Peer;
+class ValidationCache;
 class XDROutputFileStream;
 
 typedef std::shared_ptr<Peer> PeerPtr;
@@ -111,6 +112,10 @@ class Herder
     // We are learning about a new envelope.
     virtual EnvelopeStatus recvSCPEnvelope(SCPEnvelope const& envelope) = 0;
 
+    // We are learning about a new envelope from a peer: its signature is
+    // checked off the main thread before it is passed to recvSCPEnvelope.
+    virtual void recvUnverifiedSCPEnvelope(SCPEnvelope const& envelope) = 0;
+
     // We are learning about a new fully-fetched envelope.
     virtual EnvelopeStatus recvSCPEnvelope(SCPEnvelope const& envelope,
                                            const SCPQuorumSet& qset,
@@ -127,6 +132,10 @@ class Herder
     // sender in the pending or recent tx sets.
     virtual SequenceNumber getMaxSeqInPendingTxs(AccountID const&) = 0;
 
+    // outcomes of validating transactions and transaction sets against the
+    // last closed ledger
+    virtual ValidationCache& getValidationCache() = 0;
+
     virtual void triggerNextLedger(uint32_t ledgerSeqToTrigger) = 0;
 
     // lookup a nodeID in config and in SCP messages
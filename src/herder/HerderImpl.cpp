@@ -38,6 +38,11 @@ using namespace std;
 namespace stellar
 {
 
+// bounds of the envelopes from peers waiting for their signature to be
+// checked, a few slots' worth of statements per node
+static size_t const MAX_UNVERIFIED_ENVELOPES_PER_NODE = 64;
+static size_t const MAX_UNVERIFIED_ENVELOPES = 4096;
+
 std::unique_ptr<Herder>
 Herder::create(Application& app)
 {
@@ -70,7 +75,9 @@ HerderImpl::SCPMetrics::SCPMetrics(Application& app)
 }
 
 HerderImpl::HerderImpl(Application& app)
-    : mPendingTransactions(4)
+    : mTransactionQueue(app.getMetrics(),
+                        app.getConfig().TRANSACTION_QUEUE_MAX_BYTES)
+    , mValidationCache(app)
     , mPendingEnvelopes(app, *this)
     , mHerderSCPDriver(app, *this, mUpgrades, mPendingEnvelopes)
     , mLastSlotSaved(0)
@@ -81,6 +88,9 @@ HerderImpl::HerderImpl(Application& app)
     , mApp(app)
     , mLedgerManager(app.getLedgerManager())
     , mSCPMetrics(app)
+    , mEnvelopeVerifier(std::make_shared<EnvelopeVerifier>(
+          app, [this](SCPEnvelope const& e) { recvSCPEnvelope(e); },
+          MAX_UNVERIFIED_ENVELOPES_PER_NODE, MAX_UNVERIFIED_ENVELOPES))
 {
     Hash hash = getSCP().getLocalNode()->getQuorumSetHash();
     mPendingEnvelopes.addSCPQuorumSet(hash,
@@ -139,34 +149,6 @@ HerderImpl::updateSCPCounters()
         getSCP().getCumulativeStatemtCount());
 }
 
-static uint64_t
-countTxs(HerderImpl::AccountTxMap const& acc)
-{
-    uint64_t sz = 0;
-    for (auto const& a : acc)
-    {
-        sz += a.second->mTransactions.size();
-    }
-    return sz;
-}
-
-static std::shared_ptr<HerderImpl::TxMap>
-findOrAdd(HerderImpl::AccountTxMap& acc, AccountID const& aid)
-{
-    std::shared_ptr<HerderImpl::TxMap> txmap = nullptr;
-    auto i = acc.find(aid);
-    if (i == acc.end())
-    {
-        txmap = std::make_shared<HerderImpl::TxMap>();
-        acc.insert(std::make_pair(aid, txmap));
-    }
-    else
-    {
-        txmap = i->second;
-    }
-    return txmap;
-}
-
 void
 HerderImpl::valueExternalized(uint64 slotIndex, StellarValue const& value)
 {
@@ -282,31 +264,6 @@ HerderImpl::emitEnvelope(SCPEnvelope const& envelope)
     startRebroadcastTimer();
 }
 
-void
-HerderImpl::TxMap::addTx(TransactionFramePtr tx)
-{
-    auto const& h = tx->getFullHash();
-    if (mTransactions.find(h) != mTransactions.end())
-    {
-        return;
-    }
-    mTransactions.insert(std::make_pair(h, tx));
-    mMaxSeq = std::max(tx->getSeqNum(), mMaxSeq);
-    mTotalFees += tx->getFee();
-}
-
-void
-HerderImpl::TxMap::recalculate()
-{
-    mMaxSeq = 0;
-    mTotalFees = 0;
-    for (auto const& pair : mTransactions)
-    {
-        mMaxSeq = std::max(pair.second->getSeqNum(), mMaxSeq);
-        mTotalFees += pair.second->getFee();
-    }
-}
-
 Herder::TransactionSubmitStatus
 HerderImpl::recvTransaction(TransactionFramePtr tx)
 {
@@ -318,26 +275,14 @@ HerderImpl::recvTransaction(TransactionFramePtr tx)
 
     // determine if we have seen this tx before and if not if it has the right
     // seq num
-    int64_t totFee = tx->getFee();
-    SequenceNumber highSeq = 0;
-
-    for (auto& map : mPendingTransactions)
+    if (mTransactionQueue.contains(*tx))
     {
-        auto i = map.find(acc);
-        if (i != map.end())
-        {
-            auto& txmap = i->second;
-            auto j = txmap->mTransactions.find(txID);
-            if (j != txmap->mTransactions.end())
-            {
-                return TX_STATUS_DUPLICATE;
-            }
-            totFee += txmap->mTotalFees;
-            highSeq = std::max(highSeq, txmap->mMaxSeq);
-        }
+        return TX_STATUS_DUPLICATE;
     }
+    int64_t totFee = tx->getFee() + mTransactionQueue.getTotalFees(acc);
+    SequenceNumber highSeq = mTransactionQueue.getMaxSeq(acc);
 
-    if (!tx->checkValid(mApp, highSeq))
+    if (!mValidationCache.checkValid(*tx, highSeq))
     {
         return TX_STATUS_ERROR;
     }
@@ -352,12 +297,22 @@ HerderImpl::recvTransaction(TransactionFramePtr tx)
         CLOG(TRACE, "Herder") << "recv transaction " << hexAbbrev(txID)
                               << " for " << KeyUtils::toShortString(acc);
 
-    auto txmap = findOrAdd(mPendingTransactions[0], acc);
-    txmap->addTx(tx);
+    if (!mTransactionQueue.add(tx))
+    {
+        // the queue is full of transactions paying more
+        tx->getResult().result.code(txINSUFFICIENT_FEE);
+        return TX_STATUS_ERROR;
+    }
 
     return TX_STATUS_PENDING;
 }
 
+void
+HerderImpl::recvUnverifiedSCPEnvelope(SCPEnvelope const& envelope)
+{
+    mEnvelopeVerifier->add(envelope);
+}
+
 Herder::EnvelopeStatus
 HerderImpl::recvSCPEnvelope(SCPEnvelope const& envelope)
 {
@@ -590,49 +545,6 @@ HerderImpl::ledgerClosed()
                                  &VirtualTimer::onFailureNoop);
 }
 
-void
-HerderImpl::removeReceivedTxs(std::vector<TransactionFramePtr> const& dropTxs)
-{
-    for (auto& m : mPendingTransactions)
-    {
-        if (m.empty())
-        {
-            continue;
-        }
-
-        std::set<std::shared_ptr<TxMap>> toRecalculate;
-
-        for (auto const& tx : dropTxs)
-        {
-            auto const& acc = tx->getSourceID();
-            auto const& txID = tx->getFullHash();
-            auto i = m.find(acc);
-            if (i != m.end())
-            {
-                auto& txs = i->second->mTransactions;
-                auto j = txs.find(txID);
-                if (j != txs.end())
-                {
-                    txs.erase(j);
-                    if (txs.empty())
-                    {
-                        m.erase(i);
-                    }
-                    else
-                    {
-                        toRecalculate.insert(i->second);
-                    }
-                }
-            }
-        }
-
-        for (auto txm : toRecalculate)
-        {
-            txm->recalculate();
-        }
-    }
-}
-
 bool
 HerderImpl::recvSCPQuorumSet(Hash const& hash, const SCPQuorumSet& qset)
 {
@@ -688,17 +600,13 @@ HerderImpl::getCurrentLedgerSeq() const
 SequenceNumber
 HerderImpl::getMaxSeqInPendingTxs(AccountID const& acc)
 {
-    SequenceNumber highSeq = 0;
-    for (auto const& m : mPendingTransactions)
-    {
-        auto i = m.find(acc);
-        if (i == m.end())
-        {
-            continue;
-        }
-        highSeq = std::max(i->second->mMaxSeq, highSeq);
-    }
-    return highSeq;
+    return mTransactionQueue.getMaxSeq(acc);
+}
+
+ValidationCache&
+HerderImpl::getValidationCache()
+{
+    return mValidationCache;
 }
 
 // called to take a position during the next round
@@ -714,35 +622,34 @@ HerderImpl::triggerNextLedger(uint32_t ledgerSeqToTrigger)
     }
     updateSCPCounters();
 
-    // our first choice for this round's set is all the tx we have collected
-    // during last ledger close
+    // our choice for this round's set is the best valid transactions we have
+    // collected, as many as fit in a ledger
     auto const& lcl = mLedgerManager.getLastClosedLedgerHeader();
-    auto proposedSet = std::make_shared<TxSetFrame>(lcl.hash);
-
-    for (auto const& m : mPendingTransactions)
+    size_t maxTxs = mLedgerManager.getMaxTxSetSize();
+    TxSetFramePtr proposedSet;
+    std::vector<TransactionFramePtr> removed;
+    do
     {
-        for (auto const& pair : m)
+        proposedSet = std::make_shared<TxSetFrame>(lcl.hash);
+        for (auto const& tx : mTransactionQueue.getBestTransactions(maxTxs))
         {
-            for (auto const& tx : pair.second->mTransactions)
-            {
-                proposedSet->add(tx.second);
-            }
+            proposedSet->add(tx);
         }
-    }
 
-    std::vector<TransactionFramePtr> removed;
-    proposedSet->trimInvalid(mApp, removed);
-    removeReceivedTxs(removed);
-
-    proposedSet->surgePricingFilter(mLedgerManager);
+        // drop the invalid ones, and fill their places from the queue if
+        // it has more
+        removed.clear();
+        proposedSet->trimInvalid(mApp, removed);
+        mTransactionQueue.remove(removed);
+    } while (!removed.empty() && proposedSet->size() < maxTxs &&
+             mTransactionQueue.size() > proposedSet->size());
 
-    if (!proposedSet->checkValid(mApp))
+    auto txSetHash = proposedSet->getContentsHash();
+    if (!mValidationCache.checkValid(*proposedSet, txSetHash))
     {
         throw std::runtime_error("wanting to emit an invalid txSet");
     }
 
-    auto txSetHash = proposedSet->getContentsHash();
-
     // use the slot index from ledger manager here as our vote is based off
     // the last closed ledger stored in ledger manager
     uint32_t slotIndex = lcl.header.ledgerSeq + 1;
@@ -1056,29 +963,20 @@ void
 HerderImpl::updatePendingTransactions(
     std::vector<TransactionFramePtr> const& applied)
 {
-    // remove all these tx from mPendingTransactions
-    removeReceivedTxs(applied);
+    // remove all these tx from mTransactionQueue
+    mTransactionQueue.remove(applied);
 
-    // drop the highest level
-    mPendingTransactions.erase(--mPendingTransactions.end());
-
-    // shift entries up
-    mPendingTransactions.emplace_front();
+    // age the others, dropping the oldest
+    mTransactionQueue.shift();
 
     // rebroadcast entries, sorted in apply-order to maximize chances of
     // propagation
     {
         Hash h;
         TxSetFrame toBroadcast(h);
-        for (auto const& l : mPendingTransactions)
+        for (auto const& tx : mTransactionQueue.getTransactions())
         {
-            for (auto const& pair : l)
-            {
-                for (auto const& tx : pair.second->mTransactions)
-                {
-                    toBroadcast.add(tx.second);
-                }
-            }
+            toBroadcast.add(tx);
         }
         for (auto tx : toBroadcast.sortForApply())
         {
@@ -1087,10 +985,11 @@ HerderImpl::updatePendingTransactions(
         }
     }
 
-    mSCPMetrics.mHerderPendingTxs0.set_count(countTxs(mPendingTransactions[0]));
-    mSCPMetrics.mHerderPendingTxs1.set_count(countTxs(mPendingTransactions[1]));
-    mSCPMetrics.mHerderPendingTxs2.set_count(countTxs(mPendingTransactions[2]));
-    mSCPMetrics.mHerderPendingTxs3.set_count(countTxs(mPendingTransactions[3]));
+    auto const& sizeByAge = mTransactionQueue.sizeByAge();
+    mSCPMetrics.mHerderPendingTxs0.set_count(sizeByAge[0]);
+    mSCPMetrics.mHerderPendingTxs1.set_count(sizeByAge[1]);
+    mSCPMetrics.mHerderPendingTxs2.set_count(sizeByAge[2]);
+    mSCPMetrics.mHerderPendingTxs3.set_count(sizeByAge[3]);
 }
 
 void
@@ -5,13 +5,14 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "PendingEnvelopes.h"
+#include "herder/EnvelopeVerifier.h"
 #include "herder/Herder.h"
 #include "herder/HerderSCPDriver.h"
+#include "herder/TransactionQueue.h"
+#include "herder/ValidationCache.h"
 #include "herder/Upgrades.h"
 #include "util/Timer.h"
-#include <deque>
 #include <memory>
-#include <unordered_map>
 #include <vector>
 
 namespace medida
@@ -61,6 +62,7 @@ class HerderImpl : public Herder
 
     TransactionSubmitStatus recvTransaction(TransactionFramePtr tx) override;
 
+    void recvUnverifiedSCPEnvelope(SCPEnvelope const& envelope) override;
     EnvelopeStatus recvSCPEnvelope(SCPEnvelope const& envelope) override;
     EnvelopeStatus recvSCPEnvelope(SCPEnvelope const& envelope,
                                    const SCPQuorumSet& qset,
@@ -81,6 +83,8 @@ class HerderImpl : public Herder
 
     SequenceNumber getMaxSeqInPendingTxs(AccountID const&) override;
 
+    ValidationCache& getValidationCache() override;
+
     void triggerNextLedger(uint32_t ledgerSeqToTrigger) override;
 
     void setUpgrades(Upgrades::UpgradeParameters const& upgrades) override;
@@ -92,19 +96,8 @@ class HerderImpl : public Herder
     void dumpQuorumInfo(Json::Value& ret, NodeID const& id, bool summary,
                         uint64 index) override;
 
-    struct TxMap
-    {
-        SequenceNumber mMaxSeq{0};
-        int64_t mTotalFees{0};
-        std::unordered_map<Hash, TransactionFramePtr> mTransactions;
-        void addTx(TransactionFramePtr);
-        void recalculate();
-    };
-    typedef std::unordered_map<AccountID, std::shared_ptr<TxMap>> AccountTxMap;
-
   private:
     void ledgerClosed();
-    void removeReceivedTxs(std::vector<TransactionFramePtr> const& txs);
 
     void startRebroadcastTimer();
     void rebroadcast();
@@ -114,11 +107,8 @@ class HerderImpl : public Herder
 
     void processSCPQueueUpToIndex(uint64 slotIndex);
 
-    // 0- tx we got during ledger close
-    // 1- one ledger ago. rebroadcast
-    // 2- two ledgers ago. rebroadcast
-    // ...
-    std::deque<AccountTxMap> mPendingTransactions;
+    TransactionQueue mTransactionQueue;
+    ValidationCache mValidationCache;
 
     void
     updatePendingTransactions(std::vector<TransactionFramePtr> const& applied);
@@ -186,5 +176,8 @@ class HerderImpl : public Herder
     };
 
     SCPMetrics mSCPMetrics;
+
+    // envelopes from peers waiting for their signature to be checked
+    std::shared_ptr<EnvelopeVerifier> mEnvelopeVerifier;
 };
 }
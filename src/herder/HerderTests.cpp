@@ -21,7 +21,10 @@
 #include "simulation/Simulation.h"
 #include "test/TxTests.h"
 
+#include "medida/meter.h"
+#include "medida/metrics_registry.h"
 #include "xdrpp/marshal.h"
+#include <thread>
 
 using namespace stellar;
 using namespace stellar::txtest;
@@ -292,6 +295,109 @@ TEST_CASE("txset", "[herder]")
             txSet->trimInvalid(*app, removed);
             REQUIRE(txSet->checkValid(*app));
         }
+        SECTION("bad signature")
+        {
+            // from another account, so that signatures are checked on the
+            // worker threads
+            auto tx = root.tx({payment(accounts[0], paymentAmount)});
+            tx->getEnvelope().signatures[0].signature[0] ^= 1;
+            txSet->add(tx);
+            txSet->sortForHash();
+            REQUIRE(!txSet->checkValid(*app));
+
+            std::vector<TransactionFramePtr> removed;
+            txSet->trimInvalid(*app, removed);
+            REQUIRE(removed == std::vector<TransactionFramePtr>{tx});
+            REQUIRE(txSet->checkValid(*app));
+        }
+    }
+    SECTION("signatures checked ahead")
+    {
+        txSet->add(root.tx({payment(accounts[0], paymentAmount)}));
+        txSet->sortForHash();
+
+        PubKeyUtils::clearVerifySigCache();
+        txSet->verifySignatures(*app);
+        uint64_t hits, misses;
+        PubKeyUtils::flushVerifySigCacheCounts(hits, misses);
+        REQUIRE(txSet->checkValid(*app));
+        PubKeyUtils::flushVerifySigCacheCounts(hits, misses);
+        // nothing is checked ahead on a single core
+        if (std::thread::hardware_concurrency() > 1)
+        {
+            REQUIRE(misses == 0);
+            REQUIRE(hits >= txSet->size());
+        }
+    }
+}
+
+TEST_CASE("validation cache", "[herder]")
+{
+    VirtualClock clock;
+    Application::pointer app = createTestApplication(clock, getTestConfig());
+    app->start();
+
+    auto root = TestAccount::createRoot(*app);
+    auto dest = root.create("dest", app->getLedgerManager().getMinBalance(0));
+    closeLedgerOn(*app, 2, 1, 1, 2017);
+
+    auto& cache = app->getHerder().getValidationCache();
+    auto& metrics = app->getMetrics();
+    auto txHits = [&]() {
+        return metrics.NewMeter({"herder", "validation-cache", "tx-hit"},
+                                "transaction")
+            .count();
+    };
+    auto txSetHits = [&]() {
+        return metrics.NewMeter({"herder", "validation-cache", "txset-hit"},
+                                "txset")
+            .count();
+    };
+
+    auto tx1 = root.tx({payment(dest, 100)});
+    auto tx2 = root.tx({payment(dest, 100)});
+
+    SECTION("transactions")
+    {
+        REQUIRE(cache.checkValid(*tx1, 0));
+        REQUIRE(txHits() == 0);
+        REQUIRE(cache.checkValid(*tx1, 0));
+        REQUIRE(cache.checkValid(*tx1, tx1->getSeqNum() - 1));
+        REQUIRE(txHits() == 2);
+        REQUIRE(tx1->getSourceAccount().getID() == root.getPublicKey());
+
+        // valid after its predecessor doesn't make it valid on its own
+        REQUIRE(cache.checkValid(*tx2, tx1->getSeqNum()));
+        REQUIRE(!cache.checkValid(*tx2, 0));
+        REQUIRE(txHits() == 2);
+
+        // closing the ledger validates tx1 once more, then forgets it
+        closeLedgerOn(*app, 3, 2, 1, 2017, {tx1});
+        REQUIRE(txHits() == 3);
+        REQUIRE(!cache.checkValid(*tx1, 0));
+        REQUIRE(cache.checkValid(*tx2, 0));
+        REQUIRE(txHits() == 3);
+    }
+
+    SECTION("transaction sets")
+    {
+        auto txSet = std::make_shared<TxSetFrame>(
+            app->getLedgerManager().getLastClosedLedgerHeader().hash);
+        txSet->add(tx1);
+        txSet->add(tx2);
+        auto hash = txSet->getContentsHash();
+
+        REQUIRE(cache.checkValid(*txSet, hash));
+        REQUIRE(cache.checkValid(*txSet, hash));
+        REQUIRE(txSetHits() == 1);
+
+        // the transactions were validated along with the set
+        REQUIRE(cache.checkValid(*tx1, 0));
+        REQUIRE(txHits() == 1);
+
+        closeLedgerOn(*app, 3, 2, 1, 2017);
+        REQUIRE(!cache.checkValid(*txSet, hash));
+        REQUIRE(txSetHits() == 1);
     }
 }
 
@@ -125,6 +125,9 @@ PendingEnvelopes::recvTxSet(Hash hash, TxSetFramePtr txset)
         return false;
     }
 
+    // get the signatures checked while the envelopes waiting for the set are
+    // processed and it is validated
+    txset->preverifySignatures(mApp);
     addTxSet(hash, lastSeenSlotIndex, txset);
     return true;
 }
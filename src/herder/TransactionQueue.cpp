@@ -0,0 +1,334 @@
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "herder/TransactionQueue.h"
+#include "medida/counter.h"
+#include "medida/meter.h"
+#include "medida/metrics_registry.h"
+#include "xdrpp/marshal.h"
+#include <algorithm>
+#include <cassert>
+
+namespace stellar
+{
+
+using xdr::operator<;
+using xdr::operator==;
+
+bool
+TransactionQueue::ByFeeLevel::
+operator()(std::pair<FeeLevel, AccountID> const& a,
+           std::pair<FeeLevel, AccountID> const& b) const
+{
+    auto lhs = a.first.mFee * b.first.mOps;
+    auto rhs = b.first.mFee * a.first.mOps;
+    if (lhs != rhs)
+    {
+        return lhs > rhs;
+    }
+    return a.second < b.second;
+}
+
+TransactionQueue::TransactionQueue(medida::MetricsRegistry& metrics,
+                                   size_t maxBytes)
+    : mMaxBytes(maxBytes)
+    , mSizeCounter(metrics.NewCounter({"herder", "pending-txs", "count"}))
+    , mBytesCounter(metrics.NewCounter({"herder", "pending-txs", "bytes"}))
+    , mEvicted(
+          metrics.NewMeter({"herder", "pending-txs", "evicted"}, "transaction"))
+{
+    mSizeByAge.fill(0);
+}
+
+TransactionQueue::FeeLevel
+TransactionQueue::getFeeLevel(TransactionFrame const& tx)
+{
+    // as in TransactionFrame::getMinFee
+    int64_t ops = std::max<int64_t>(1, tx.getOperations().size());
+    return FeeLevel{tx.getFee(), ops};
+}
+
+bool
+TransactionQueue::isLower(FeeLevel const& a, FeeLevel const& b)
+{
+    return a.mFee * b.mOps < b.mFee * a.mOps;
+}
+
+TransactionQueue::FeeLevel
+TransactionQueue::getFeeLevel(
+    std::map<SequenceNumber, QueuedTx>::const_iterator begin,
+    std::map<SequenceNumber, QueuedTx>::const_iterator end)
+{
+    assert(begin != end);
+    auto res = getFeeLevel(*begin->second.mTx);
+    for (++begin; begin != end; ++begin)
+    {
+        auto level = getFeeLevel(*begin->second.mTx);
+        if (isLower(level, res))
+        {
+            res = level;
+        }
+    }
+    return res;
+}
+
+void
+TransactionQueue::updateFeeLevel(AccountID const& id, AccountTxs& acc)
+{
+    mByFeeLevel.erase(std::make_pair(acc.mFeeLevel, id));
+    if (acc.mTransactions.empty())
+    {
+        return;
+    }
+
+    acc.mFeeLevel =
+        getFeeLevel(acc.mTransactions.cbegin(), acc.mTransactions.cend());
+    mByFeeLevel.emplace(acc.mFeeLevel, id);
+}
+
+bool
+TransactionQueue::canEvict(size_t bytes,
+                           std::pair<FeeLevel, AccountID> const& bound) const
+{
+    ByFeeLevel cmp;
+    // The accounts evicted from so far, at their level once evicted from,
+    // and how many of their transactions are left. Their level can only
+    // rise, so the lowest account is either one of them or the next one of
+    // mByFeeLevel not considered yet.
+    std::set<std::pair<FeeLevel, AccountID>, ByFeeLevel> evicted;
+    std::unordered_map<AccountID, size_t> left;
+    auto next = mByFeeLevel.rbegin();
+
+    size_t freed = 0;
+    while (freed < bytes)
+    {
+        std::pair<FeeLevel, AccountID> lowest;
+        if (next != mByFeeLevel.rend() &&
+            (evicted.empty() || cmp(*evicted.rbegin(), *next)))
+        {
+            lowest = *next++;
+        }
+        else if (!evicted.empty())
+        {
+            lowest = *evicted.rbegin();
+            evicted.erase(std::prev(evicted.end()));
+        }
+        else
+        {
+            return false;
+        }
+        if (!cmp(bound, lowest))
+        {
+            return false;
+        }
+
+        auto const& txs = mAccounts.find(lowest.second)->second.mTransactions;
+        auto n = left.emplace(lowest.second, txs.size()).first;
+        auto last = std::next(txs.cbegin(), --n->second);
+        freed += last->second.mBytes;
+        if (n->second != 0)
+        {
+            evicted.emplace(getFeeLevel(txs.cbegin(), last), lowest.second);
+        }
+    }
+    return true;
+}
+
+void
+TransactionQueue::updateMetrics()
+{
+    mSizeCounter.set_count(mSize);
+    mBytesCounter.set_count(mBytes);
+}
+
+void
+TransactionQueue::erase(std::unordered_map<AccountID, AccountTxs>::iterator acc,
+                        std::map<SequenceNumber, QueuedTx>::iterator tx)
+{
+    auto& txs = acc->second;
+    mBytes -= tx->second.mBytes;
+    mSize--;
+    mSizeByAge[tx->second.mAge]--;
+    txs.mTotalFees -= tx->second.mTx->getFee();
+    txs.mTransactions.erase(tx);
+    updateFeeLevel(acc->first, txs);
+    if (txs.mTransactions.empty())
+    {
+        mAccounts.erase(acc);
+    }
+}
+
+bool
+TransactionQueue::contains(TransactionFrame const& tx) const
+{
+    auto acc = mAccounts.find(tx.getSourceID());
+    if (acc == mAccounts.end())
+    {
+        return false;
+    }
+    auto const& txs = acc->second.mTransactions;
+    auto it = txs.find(tx.getSeqNum());
+    return it != txs.end() && it->second.mTx->getFullHash() == tx.getFullHash();
+}
+
+SequenceNumber
+TransactionQueue::getMaxSeq(AccountID const& id) const
+{
+    auto acc = mAccounts.find(id);
+    if (acc == mAccounts.end())
+    {
+        return 0;
+    }
+    return acc->second.mTransactions.rbegin()->first;
+}
+
+int64_t
+TransactionQueue::getTotalFees(AccountID const& id) const
+{
+    auto acc = mAccounts.find(id);
+    return acc == mAccounts.end() ? 0 : acc->second.mTotalFees;
+}
+
+bool
+TransactionQueue::add(TransactionFramePtr tx)
+{
+    auto const& id = tx->getSourceID();
+    size_t bytes = xdr::xdr_size(tx->getEnvelope());
+
+    // make sure there is room for `tx` before evicting anything
+    if (mBytes + bytes > mMaxBytes)
+    {
+        auto level = getFeeLevel(*tx);
+        auto existing = mAccounts.find(id);
+        if (existing != mAccounts.end() &&
+            isLower(existing->second.mFeeLevel, level))
+        {
+            level = existing->second.mFeeLevel;
+        }
+        if (!canEvict(mBytes + bytes - mMaxBytes, std::make_pair(level, id)))
+        {
+            return false;
+        }
+    }
+
+    auto& acc = mAccounts[id];
+    assert(acc.mTransactions.empty() ||
+           acc.mTransactions.rbegin()->first < tx->getSeqNum());
+
+    acc.mTransactions.emplace(tx->getSeqNum(), QueuedTx{tx, bytes, 0});
+    acc.mTotalFees += tx->getFee();
+    updateFeeLevel(id, acc);
+    mBytes += bytes;
+    mSize++;
+    mSizeByAge[0]++;
+
+    // as canEvict found, this only evicts from accounts with a lower fee level
+    while (mBytes > mMaxBytes)
+    {
+        auto const& lowest = mByFeeLevel.rbegin()->second;
+        auto evict = mAccounts.find(lowest);
+        auto last = std::prev(evict->second.mTransactions.end());
+        assert(last->second.mTx != tx);
+        mEvicted.Mark();
+        erase(evict, last);
+    }
+    updateMetrics();
+    return true;
+}
+
+void
+TransactionQueue::remove(std::vector<TransactionFramePtr> const& txs)
+{
+    for (auto const& tx : txs)
+    {
+        auto acc = mAccounts.find(tx->getSourceID());
+        if (acc == mAccounts.end())
+        {
+            continue;
+        }
+        auto it = acc->second.mTransactions.find(tx->getSeqNum());
+        if (it != acc->second.mTransactions.end() &&
+            it->second.mTx->getFullHash() == tx->getFullHash())
+        {
+            erase(acc, it);
+        }
+    }
+    updateMetrics();
+}
+
+void
+TransactionQueue::shift()
+{
+    for (auto acc = mAccounts.begin(); acc != mAccounts.end();)
+    {
+        auto& txs = acc->second;
+        bool changed = false;
+        for (auto it = txs.mTransactions.begin();
+             it != txs.mTransactions.end();)
+        {
+            if (++it->second.mAge < MAX_AGE)
+            {
+                ++it;
+                continue;
+            }
+            mBytes -= it->second.mBytes;
+            mSize--;
+            txs.mTotalFees -= it->second.mTx->getFee();
+            it = txs.mTransactions.erase(it);
+            changed = true;
+        }
+        if (changed)
+        {
+            updateFeeLevel(acc->first, txs);
+        }
+        if (txs.mTransactions.empty())
+        {
+            acc = mAccounts.erase(acc);
+        }
+        else
+        {
+            ++acc;
+        }
+    }
+
+    std::rotate(mSizeByAge.begin(), mSizeByAge.end() - 1, mSizeByAge.end());
+    mSizeByAge[0] = 0;
+    updateMetrics();
+}
+
+std::vector<TransactionFramePtr>
+TransactionQueue::getBestTransactions(size_t maxTxs) const
+{
+    std::vector<TransactionFramePtr> res;
+    res.reserve(std::min(maxTxs, mSize));
+    for (auto const& level : mByFeeLevel)
+    {
+        auto const& txs = mAccounts.find(level.second)->second.mTransactions;
+        for (auto const& tx : txs)
+        {
+            if (res.size() == maxTxs)
+            {
+                return res;
+            }
+            res.emplace_back(tx.second.mTx);
+        }
+    }
+    return res;
+}
+
+std::vector<TransactionFramePtr>
+TransactionQueue::getTransactions() const
+{
+    std::vector<TransactionFramePtr> res;
+    res.reserve(mSize);
+    for (auto const& acc : mAccounts)
+    {
+        for (auto const& tx : acc.second.mTransactions)
+        {
+            res.emplace_back(tx.second.mTx);
+        }
+    }
+    return res;
+}
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "transactions/TransactionFrame.h"
+#include "util/NonCopyable.h"
+#include <array>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace medida
+{
+class Counter;
+class Meter;
+class MetricsRegistry;
+}
+
+namespace stellar
+{
+
+/**
+ * Transactions received from the network or from clients, waiting to be
+ * included in a ledger.
+ *
+ * Each account's transactions are kept as a chain ordered by sequence number,
+ * and the accounts themselves are indexed by their fee level: the lowest fee
+ * per operation among their transactions, which is what surge pricing ranks
+ * accounts by. This makes inserting or removing a transaction O(log n), and
+ * lets `getBestTransactions` pick the transactions surge pricing would keep
+ * without sorting the whole queue.
+ *
+ * The queue holds at most a given number of bytes of transaction envelopes;
+ * beyond that, the last transaction of the account with the lowest fee level
+ * is evicted, which keeps every account's chain contiguous. A transaction is
+ * only queued if evicting from accounts with a lower fee level than its own
+ * account's makes enough room for it; otherwise nothing is evicted.
+ *
+ * Transactions also age by one every ledger, and are dropped once they reach
+ * `MAX_AGE`.
+ */
+class TransactionQueue : NonMovableOrCopyable
+{
+  public:
+    static size_t const MAX_AGE = 4;
+
+  private:
+    struct QueuedTx
+    {
+        TransactionFramePtr mTx;
+        size_t mBytes;
+        uint32_t mAge;
+    };
+
+    // A fee per operation, as fee and number of operations so that fee
+    // levels compare exactly.
+    struct FeeLevel
+    {
+        int64_t mFee;
+        int64_t mOps;
+    };
+
+    struct AccountTxs
+    {
+        std::map<SequenceNumber, QueuedTx> mTransactions;
+        int64_t mTotalFees{0};
+        FeeLevel mFeeLevel{0, 1};
+    };
+
+    // Highest fee level first, then by account ID, as surge pricing orders
+    // them.
+    struct ByFeeLevel
+    {
+        bool operator()(std::pair<FeeLevel, AccountID> const& a,
+                        std::pair<FeeLevel, AccountID> const& b) const;
+    };
+
+    size_t const mMaxBytes;
+    size_t mBytes{0};
+    size_t mSize{0};
+    std::array<size_t, MAX_AGE> mSizeByAge;
+
+    std::unordered_map<AccountID, AccountTxs> mAccounts;
+    std::set<std::pair<FeeLevel, AccountID>, ByFeeLevel> mByFeeLevel;
+
+    medida::Counter& mSizeCounter;
+    medida::Counter& mBytesCounter;
+    medida::Meter& mEvicted;
+
+    static FeeLevel getFeeLevel(TransactionFrame const& tx);
+    static bool isLower(FeeLevel const& a, FeeLevel const& b);
+    static FeeLevel
+    getFeeLevel(std::map<SequenceNumber, QueuedTx>::const_iterator begin,
+                std::map<SequenceNumber, QueuedTx>::const_iterator end);
+
+    // Whether evicting as `add` does, only from accounts that come after
+    // `bound` in mByFeeLevel, frees at least `bytes`.
+    bool canEvict(size_t bytes,
+                  std::pair<FeeLevel, AccountID> const& bound) const;
+
+    // Remove an account's transaction, keeping the account's totals and its
+    // place in mByFeeLevel up to date.
+    void erase(std::unordered_map<AccountID, AccountTxs>::iterator acc,
+               std::map<SequenceNumber, QueuedTx>::iterator tx);
+    void updateFeeLevel(AccountID const& id, AccountTxs& acc);
+    void updateMetrics();
+
+  public:
+    TransactionQueue(medida::MetricsRegistry& metrics, size_t maxBytes);
+
+    // Whether `tx` itself is queued.
+    bool contains(TransactionFrame const& tx) const;
+
+    // The highest sequence number, and the sum of the fees, of the queued
+    // transactions of `id`; 0 if it has none.
+    SequenceNumber getMaxSeq(AccountID const& id) const;
+    int64_t getTotalFees(AccountID const& id) const;
+
+    // Precondition: `tx` is valid and follows its account's queued
+    // transactions. Returns false if the queue is too full of transactions
+    // paying a higher fee, in which case `tx` is not queued and nothing is
+    // evicted.
+    bool add(TransactionFramePtr tx);
+
+    // Remove these transactions, where queued.
+    void remove(std::vector<TransactionFramePtr> const& txs);
+
+    // Age every transaction by one ledger, dropping those that reach MAX_AGE.
+    void shift();
+
+    // At most `maxTxs` transactions, chosen as surge pricing would: whole
+    // chains of the accounts with the highest fee levels first.
+    std::vector<TransactionFramePtr>
+    getBestTransactions(size_t maxTxs) const;
+
+    std::vector<TransactionFramePtr> getTransactions() const;
+
+    size_t
+    size() const
+    {
+        return mSize;
+    }
+
+    size_t
+    bytes() const
+    {
+        return mBytes;
+    }
+
+    // Number of transactions of each age.
+    std::array<size_t, MAX_AGE> const&
+    sizeByAge() const
+    {
+        return mSizeByAge;
+    }
+};
+}
@@ -0,0 +1,194 @@
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "herder/TransactionQueue.h"
+#include "lib/catch.hpp"
+#include "main/Application.h"
+#include "test/TestAccount.h"
+#include "test/TestUtils.h"
+#include "test/TxTests.h"
+#include "test/test.h"
+#include "util/Logging.h"
+#include "util/Timer.h"
+#include "xdrpp/marshal.h"
+#include <chrono>
+
+using namespace stellar;
+using namespace stellar::txtest;
+
+TEST_CASE("transaction queue", "[herder][txqueue]")
+{
+    VirtualClock clock;
+    Application::pointer app = createTestApplication(clock, getTestConfig());
+    app->start();
+
+    auto root = TestAccount::createRoot(*app);
+    auto dest = root.create("dest", 500000000);
+    auto accountB = root.create("accountB", 5000000000);
+    auto accountC = root.create("accountC", 5000000000);
+
+    auto makeTx = [&](TestAccount& account, uint32_t feeMultiplier) {
+        auto tx = account.tx({payment(dest, 10)});
+        tx->getEnvelope().tx.fee *= feeMultiplier;
+        return tx;
+    };
+
+    SECTION("chains and fee order")
+    {
+        TransactionQueue queue(app->getMetrics(), 1024 * 1024);
+        std::vector<TransactionFramePtr> rootTxs, bTxs;
+        for (int i = 0; i < 3; i++)
+        {
+            rootTxs.emplace_back(makeTx(root, 1));
+            REQUIRE(queue.add(rootTxs.back()));
+            bTxs.emplace_back(makeTx(accountB, 2));
+            REQUIRE(queue.add(bTxs.back()));
+        }
+        REQUIRE(queue.size() == 6);
+        REQUIRE(queue.contains(*rootTxs[1]));
+        REQUIRE(queue.getMaxSeq(root.getPublicKey()) ==
+                rootTxs[2]->getSeqNum());
+        REQUIRE(queue.getTotalFees(accountB.getPublicKey()) ==
+                3 * bTxs[0]->getFee());
+        REQUIRE(queue.getMaxSeq(accountC.getPublicKey()) == 0);
+
+        auto best = queue.getBestTransactions(4);
+        REQUIRE(best == std::vector<TransactionFramePtr>{bTxs[0], bTxs[1],
+                                                         bTxs[2], rootTxs[0]});
+
+        // one cheap transaction lowers its whole account's fee level
+        auto cheap = makeTx(accountB, 1);
+        cheap->getEnvelope().tx.fee -= 1;
+        REQUIRE(queue.add(cheap));
+        best = queue.getBestTransactions(2);
+        REQUIRE(best == std::vector<TransactionFramePtr>{rootTxs[0],
+                                                         rootTxs[1]});
+
+        queue.remove({cheap, rootTxs[0]});
+        REQUIRE(!queue.contains(*cheap));
+        REQUIRE(queue.size() == 5);
+        REQUIRE(queue.getBestTransactions(1) ==
+                std::vector<TransactionFramePtr>{bTxs[0]});
+    }
+
+    SECTION("ages")
+    {
+        TransactionQueue queue(app->getMetrics(), 1024 * 1024);
+        auto tx1 = makeTx(root, 1);
+        REQUIRE(queue.add(tx1));
+        queue.shift();
+        queue.shift();
+        auto tx2 = makeTx(root, 1);
+        REQUIRE(queue.add(tx2));
+        REQUIRE(queue.sizeByAge()[0] == 1);
+        REQUIRE(queue.sizeByAge()[2] == 1);
+
+        queue.shift();
+        queue.shift();
+        REQUIRE(!queue.contains(*tx1));
+        REQUIRE(queue.contains(*tx2));
+        REQUIRE(queue.sizeByAge()[2] == 1);
+        REQUIRE(queue.getTotalFees(root.getPublicKey()) == tx2->getFee());
+
+        queue.shift();
+        queue.shift();
+        REQUIRE(queue.size() == 0);
+        REQUIRE(queue.bytes() == 0);
+    }
+
+    SECTION("evicts the lowest fees when full")
+    {
+        auto rootTx1 = makeTx(root, 2);
+        auto rootTx2 = makeTx(root, 2);
+        auto bTx = makeTx(accountB, 3);
+        auto cTx = makeTx(accountC, 1);
+        size_t txBytes = xdr::xdr_size(rootTx1->getEnvelope());
+
+        TransactionQueue queue(app->getMetrics(), 2 * txBytes);
+        REQUIRE(queue.add(rootTx1));
+        REQUIRE(queue.add(rootTx2));
+
+        // the end of root's chain makes room
+        REQUIRE(queue.add(bTx));
+        REQUIRE(queue.contains(*rootTx1));
+        REQUIRE(!queue.contains(*rootTx2));
+        REQUIRE(queue.getMaxSeq(root.getPublicKey()) == rootTx1->getSeqNum());
+
+        // paying the least, it is not queued at all
+        REQUIRE(!queue.add(cTx));
+        REQUIRE(!queue.contains(*cTx));
+        REQUIRE(queue.size() == 2);
+        REQUIRE(queue.bytes() == 2 * txBytes);
+    }
+
+    SECTION("evicts nothing when it cannot make enough room")
+    {
+        auto rootTx = makeTx(root, 1);
+        auto bTx = makeTx(accountB, 3);
+        auto cTx = accountC.tx(
+            {payment(dest, 10), payment(dest, 10), payment(dest, 10)});
+        cTx->getEnvelope().tx.fee *= 2;
+        size_t txBytes = xdr::xdr_size(rootTx->getEnvelope());
+        REQUIRE(xdr::xdr_size(cTx->getEnvelope()) > txBytes);
+
+        TransactionQueue queue(app->getMetrics(), 2 * txBytes);
+        REQUIRE(queue.add(rootTx));
+        REQUIRE(queue.add(bTx));
+
+        // only root pays less, and evicting it is not enough
+        REQUIRE(!queue.add(cTx));
+        REQUIRE(!queue.contains(*cTx));
+        REQUIRE(queue.contains(*rootTx));
+        REQUIRE(queue.contains(*bTx));
+        REQUIRE(queue.size() == 2);
+        REQUIRE(queue.bytes() == 2 * txBytes);
+    }
+}
+
+TEST_CASE("transaction queue performance", "[herder][txqueue][hide]")
+{
+    VirtualClock clock;
+    Application::pointer app = createTestApplication(clock, getTestConfig());
+    app->start();
+
+    auto root = TestAccount::createRoot(*app);
+    std::vector<TestAccount> accounts;
+    for (int i = 0; i < 1000; i++)
+    {
+        accounts.emplace_back(root.create("a" + std::to_string(i), 1000000000));
+    }
+
+    std::vector<TransactionFramePtr> txs;
+    for (int n = 0; n < 100; n++)
+    {
+        for (size_t i = 0; i < accounts.size(); i++)
+        {
+            auto tx = accounts[i].tx({payment(root, 10)});
+            tx->getEnvelope().tx.fee += static_cast<uint32_t>(i % 17);
+            txs.emplace_back(tx);
+        }
+    }
+
+    TransactionQueue queue(app->getMetrics(), 1024 * 1024 * 1024);
+    auto start = std::chrono::steady_clock::now();
+    for (auto const& tx : txs)
+    {
+        queue.add(tx);
+    }
+    auto added = std::chrono::steady_clock::now();
+    auto best = queue.getBestTransactions(1000);
+    auto end = std::chrono::steady_clock::now();
+
+    REQUIRE(queue.size() == txs.size());
+    REQUIRE(best.size() == 1000);
+    LOG(INFO) << "queued " << txs.size() << " transactions in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(
+                     added - start)
+                     .count()
+              << "ms, picked the best 1000 in "
+              << std::chrono::duration_cast<std::chrono::microseconds>(
+                     end - added)
+                     .count()
+              << "us";
+}
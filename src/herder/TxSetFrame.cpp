@@ -5,13 +5,23 @@
 #include "util/asio.h"
 #include "TxSetFrame.h"
 #include "crypto/Hex.h"
+#include "crypto/KeyUtils.h"
 #include "crypto/SHA.h"
+#include "crypto/SecretKey.h"
+#include "crypto/SignerKey.h"
 #include "database/Database.h"
+#include "herder/Herder.h"
+#include "herder/ValidationCache.h"
+#include "ledger/AccountFrame.h"
 #include "main/Application.h"
 #include "main/Config.h"
+#include "transactions/SignatureUtils.h"
 #include "util/Logging.h"
 #include "xdrpp/marshal.h"
 #include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
 
 #include "xdrpp/printer.h"
 
@@ -175,15 +185,200 @@ TxSetFrame::surgePricingFilter(LedgerManager const& lm)
         }
 
         // sort tx by amount of fee they have paid
-        // remove the bottom that aren't paying enough
-        std::vector<TransactionFramePtr> tempList = mTransactions;
-        std::sort(tempList.begin(), tempList.end(), SurgeSorter(accountFeeMap));
+        // drop the bottom that aren't paying enough
+        std::sort(mTransactions.begin(), mTransactions.end(),
+                  SurgeSorter(accountFeeMap));
+        mTransactions.resize(max);
+        mHashIsValid = false;
+    }
+}
+
+namespace
+{
+// copies, so that checks can outlive the transaction set
+struct SignatureCheck
+{
+    PublicKey mKey;
+    Signature mSignature;
+    Hash mHash;
+};
+}
+
+// Some signature checks, run by whichever of a worker thread and the thread
+// waiting for them gets to them first: the worker threads also run bucket
+// merges, which can take a long time, and the waiting thread must not wait
+// for checks still queued behind them.
+class SignatureCheckTask
+{
+    std::vector<SignatureCheck> mChecks;
+    std::atomic<bool> mClaimed{false};
+    std::packaged_task<void()> mTask;
+    std::shared_future<void> mDone;
+
+  public:
+    explicit SignatureCheckTask(std::vector<SignatureCheck>&& checks)
+        : mChecks(std::move(checks)), mTask([this]() {
+            for (auto const& c : mChecks)
+            {
+                PubKeyUtils::verifySig(c.mKey, c.mSignature, c.mHash);
+            }
+        })
+    {
+        mDone = mTask.get_future().share();
+    }
+
+    // runs the checks, unless another thread started them already
+    void
+    run()
+    {
+        if (!mClaimed.exchange(true))
+        {
+            mTask();
+        }
+    }
+
+    // runs the checks if no worker thread started them yet, or waits for
+    // the worker that did
+    void
+    wait()
+    {
+        run();
+        mDone.get();
+    }
+};
+
+// Checking ed25519 signatures is most of the cost of validating and applying
+// transactions, and needs nothing from the database. So once the source
+// accounts are loaded (in one batch), check every signature matching one of
+// their signers on the worker threads, one task per account; a thread waiting
+// for the checks runs the tasks no worker has started yet itself. Sequential
+// checks that follow then find the results in the signature cache: what they
+// decide, and the order they decide it in, is unchanged. Transactions the
+// ValidationCache already knows to be valid are skipped, as their signatures
+// were checked when they were found valid.
+static std::vector<std::shared_ptr<SignatureCheckTask>>
+postSignatureChecks(
+    Application& app,
+    map<AccountID, vector<TransactionFramePtr>> const& accountTxMap)
+{
+    std::vector<std::shared_ptr<SignatureCheckTask>> done;
+    // nothing to gain from a single core
+    if (std::thread::hardware_concurrency() < 2)
+    {
+        return done;
+    }
+
+    auto& db = app.getDatabase();
+    auto& validationCache = app.getHerder().getValidationCache();
+    std::vector<LedgerKey> keys;
+    for (auto const& item : accountTxMap)
+    {
+        keys.emplace_back(accountKey(item.first));
+    }
+    AccountFrame::prefetchAccounts(keys, db);
+
+    for (auto const& item : accountTxMap)
+    {
+        auto account = AccountFrame::loadAccount(item.first, db);
+        if (!account)
+        {
+            continue;
+        }
+
+        // as in TransactionFrame::checkSignature
+        std::vector<PublicKey> signers;
+        if (account->getAccount().thresholds[0])
+        {
+            signers.emplace_back(item.first);
+        }
+        for (auto const& signer : account->getAccount().signers)
+        {
+            if (signer.key.type() == SIGNER_KEY_TYPE_ED25519)
+            {
+                signers.emplace_back(
+                    KeyUtils::convertKey<PublicKey>(signer.key));
+            }
+        }
 
-        for (auto iter = tempList.begin() + max; iter != tempList.end(); iter++)
+        std::vector<SignatureCheck> checks;
+        for (auto const& tx : item.second)
         {
-            removeTx(*iter);
+            if (validationCache.isKnownValid(*tx))
+            {
+                continue;
+            }
+            auto const& hash = tx->getContentsHash();
+            for (auto const& sig : tx->getEnvelope().signatures)
+            {
+                for (auto const& pk : signers)
+                {
+                    if (SignatureUtils::doesHintMatch(pk.ed25519(), sig.hint))
+                    {
+                        checks.emplace_back(
+                            SignatureCheck{pk, sig.signature, hash});
+                    }
+                }
+            }
         }
+        if (checks.empty())
+        {
+            continue;
+        }
+
+        auto task = std::make_shared<SignatureCheckTask>(std::move(checks));
+        done.emplace_back(task);
+        app.getWorkerIOService().post([task]() { task->run(); });
+    }
+    return done;
+}
+
+static void
+verifyAccountSignatures(
+    Application& app,
+    map<AccountID, vector<TransactionFramePtr>> const& accountTxMap)
+{
+    // nothing to gain from a single account, as the caller waits
+    if (accountTxMap.size() < 2)
+    {
+        return;
+    }
+    for (auto& task : postSignatureChecks(app, accountTxMap))
+    {
+        task->wait();
+    }
+}
+
+static map<AccountID, vector<TransactionFramePtr>>
+groupByAccount(std::vector<TransactionFramePtr> const& txs)
+{
+    map<AccountID, vector<TransactionFramePtr>> accountTxMap;
+    for (auto const& tx : txs)
+    {
+        accountTxMap[tx->getSourceID()].push_back(tx);
+    }
+    return accountTxMap;
+}
+
+void
+TxSetFrame::preverifySignatures(Application& app) const
+{
+    mPreverifyChecks = postSignatureChecks(app, groupByAccount(mTransactions));
+    mPreverified = true;
+}
+
+void
+TxSetFrame::verifySignatures(Application& app) const
+{
+    if (!mPreverified)
+    {
+        verifyAccountSignatures(app, groupByAccount(mTransactions));
+        return;
+    }
+    for (auto& task : mPreverifyChecks)
+    {
+        task->wait();
     }
+    mPreverifyChecks.clear();
 }
 
 // TODO.3 this and checkValid share a lot of code
@@ -202,6 +397,8 @@ TxSetFrame::trimInvalid(Application& app,
     {
         accountTxMap[tx->getSourceID()].push_back(tx);
     }
+    auto& validationCache = app.getHerder().getValidationCache();
+    verifyAccountSignatures(app, accountTxMap);
 
     for (auto& item : accountTxMap)
     {
@@ -213,7 +410,7 @@ TxSetFrame::trimInvalid(Application& app,
         int64_t totFee = 0;
         for (auto& tx : item.second)
         {
-            if (!tx->checkValid(app, lastSeq))
+            if (!validationCache.checkValid(*tx, lastSeq))
             {
                 trimmed.push_back(tx);
                 removeTx(tx);
@@ -288,6 +485,8 @@ TxSetFrame::checkValid(Application& app) const
         accountTxMap[tx->getSourceID()].push_back(tx);
         lastHash = tx->getFullHash();
     }
+    auto& validationCache = app.getHerder().getValidationCache();
+    verifyAccountSignatures(app, accountTxMap);
 
     for (auto& item : accountTxMap)
     {
@@ -299,7 +498,7 @@ TxSetFrame::checkValid(Application& app) const
         int64_t totFee = 0;
         for (auto& tx : item.second)
         {
-            if (!tx->checkValid(app, lastSeq))
+            if (!validationCache.checkValid(*tx, lastSeq))
             {
                 CLOG(DEBUG, "Herder")
                     << "bad txSet: " << hexAbbrev(mPreviousLedgerHash)
@@ -354,7 +553,7 @@ TxSetFrame::getContentsHash()
         hasher->add(mPreviousLedgerHash);
         for (unsigned int n = 0; n < mTransactions.size(); n++)
         {
-            hasher->add(xdr::xdr_to_opaque(mTransactions[n]->getEnvelope()));
+            hasher->add(mTransactions[n]->getEnvelopeBytes());
         }
         mHash = hasher->finish();
         mHashIsValid = true;
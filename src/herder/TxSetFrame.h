@@ -10,6 +10,7 @@
 namespace stellar
 {
 class Application;
+class SignatureCheckTask;
 
 class TxSetFrame;
 typedef std::shared_ptr<TxSetFrame> TxSetFramePtr;
@@ -21,6 +22,10 @@ class TxSetFrame
 
     Hash mPreviousLedgerHash;
 
+    // the checks posted by preverifySignatures, for verifySignatures
+    mutable bool mPreverified{false};
+    mutable std::vector<std::shared_ptr<SignatureCheckTask>> mPreverifyChecks;
+
   public:
     std::vector<TransactionFramePtr> mTransactions;
 
@@ -46,6 +51,15 @@ class TxSetFrame
                      std::vector<TransactionFramePtr>& trimmed);
     void surgePricingFilter(LedgerManager const& lm);
 
+    // Check the signatures of the transactions against the signers their
+    // source accounts have now, on the worker threads, so that validating or
+    // applying them later finds the outcomes in the signature cache.
+    // preverifySignatures returns without waiting for the checks, as soon as
+    // the set is known; verifySignatures waits for them, running those still
+    // queued itself rather than posting the checks again.
+    void preverifySignatures(Application& app) const;
+    void verifySignatures(Application& app) const;
+
     void removeTx(TransactionFramePtr tx);
 
     void
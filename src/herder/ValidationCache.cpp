@@ -0,0 +1,113 @@
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "herder/ValidationCache.h"
+#include "herder/TxSetFrame.h"
+#include "ledger/LedgerManager.h"
+#include "main/Application.h"
+#include "transactions/TransactionFrame.h"
+#include "util/types.h"
+
+#include "medida/histogram.h"
+#include "medida/meter.h"
+#include "medida/metrics_registry.h"
+
+namespace stellar
+{
+
+using xdr::operator==;
+
+// Only reached when transactions keep coming without ledgers closing.
+static size_t const kMaxValidTxs = 1 << 17;
+
+ValidationCache::ValidationCache(Application& app)
+    : mApp(app)
+    , mTxHit(app.getMetrics().NewMeter({"herder", "validation-cache", "tx-hit"},
+                                       "transaction"))
+    , mTxMiss(app.getMetrics().NewMeter(
+          {"herder", "validation-cache", "tx-miss"}, "transaction"))
+    , mTxSetHit(app.getMetrics().NewMeter(
+          {"herder", "validation-cache", "txset-hit"}, "txset"))
+    , mTxSetMiss(app.getMetrics().NewMeter(
+          {"herder", "validation-cache", "txset-miss"}, "txset"))
+    , mAvoidedPerLedger(
+          app.getMetrics().NewHistogram({"herder", "validation-cache", "avoided"}))
+{
+}
+
+void
+ValidationCache::refresh()
+{
+    auto const& lcl = mApp.getLedgerManager().getLastClosedLedgerHeader().hash;
+    if (lcl == mLastClosedLedgerHash)
+    {
+        return;
+    }
+    if (!isZero(mLastClosedLedgerHash))
+    {
+        mAvoidedPerLedger.Update(mAvoided);
+    }
+    mLastClosedLedgerHash = lcl;
+    mValidTxs.clear();
+    mTxSets.clear();
+    mAvoided = 0;
+}
+
+bool
+ValidationCache::checkValid(TransactionFrame& tx, SequenceNumber current)
+{
+    refresh();
+
+    // valid with the sequence number of its account implies valid after any
+    // predecessor with the right sequence number, but not the other way round
+    auto it = mValidTxs.find(tx.getFullHash());
+    if (it != mValidTxs.end() &&
+        (current == 0 ? it->second : current + 1 == tx.getSeqNum()) &&
+        tx.loadValidState(mApp))
+    {
+        mTxHit.Mark();
+        mAvoided++;
+        return true;
+    }
+
+    mTxMiss.Mark();
+    if (!tx.checkValid(mApp, current))
+    {
+        return false;
+    }
+    if (mValidTxs.size() >= kMaxValidTxs)
+    {
+        mValidTxs.clear();
+    }
+    auto& fromAccount = mValidTxs[tx.getFullHash()];
+    fromAccount = fromAccount || current == 0;
+    return true;
+}
+
+bool
+ValidationCache::checkValid(TxSetFrame const& txSet, Hash const& hash)
+{
+    refresh();
+
+    auto it = mTxSets.find(hash);
+    if (it != mTxSets.end())
+    {
+        mTxSetHit.Mark();
+        mAvoided++;
+        return it->second;
+    }
+
+    mTxSetMiss.Mark();
+    bool valid = txSet.checkValid(mApp);
+    mTxSets[hash] = valid;
+    return valid;
+}
+
+bool
+ValidationCache::isKnownValid(TransactionFrame const& tx)
+{
+    refresh();
+    return mValidTxs.find(tx.getFullHash()) != mValidTxs.end();
+}
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "overlay/StellarXDR.h"
+#include "util/HashOfHash.h"
+#include "util/NonCopyable.h"
+#include <unordered_map>
+
+namespace medida
+{
+class Histogram;
+class Meter;
+}
+
+namespace stellar
+{
+class Application;
+class TransactionFrame;
+class TxSetFrame;
+
+/**
+ * Remembers which transactions, and which transaction sets, were found valid
+ * (or, for sets, invalid) against the last closed ledger, so that validating
+ * them again is a lookup. The same set is typically validated once per peer
+ * nominating or voting for it, and each pending transaction by
+ * recvTransaction, trimInvalid and every set containing it.
+ *
+ * Validity only depends on the transaction or set and on the state of the last
+ * closed ledger, so everything is forgotten as soon as that changes. The
+ * number of validations avoided while it was current is then recorded in the
+ * "herder.validation-cache.avoided" histogram, once per ledger.
+ */
+class ValidationCache : NonMovableOrCopyable
+{
+    Application& mApp;
+
+    Hash mLastClosedLedgerHash;
+    // valid transactions, by full hash, to whether they were also found valid
+    // without a given predecessor sequence number (current == 0)
+    std::unordered_map<Hash, bool> mValidTxs;
+    std::unordered_map<Hash, bool> mTxSets;
+    int64_t mAvoided{0};
+
+    medida::Meter& mTxHit;
+    medida::Meter& mTxMiss;
+    medida::Meter& mTxSetHit;
+    medida::Meter& mTxSetMiss;
+    medida::Histogram& mAvoidedPerLedger;
+
+    // forget everything if the last closed ledger changed
+    void refresh();
+
+  public:
+    ValidationCache(Application& app);
+
+    // TransactionFrame::checkValid, unless `tx` is known to be valid with
+    // this `current`, in which case only its source account is loaded.
+    bool checkValid(TransactionFrame& tx, SequenceNumber current);
+
+    // TxSetFrame::checkValid, unless the outcome for the set with contents
+    // hash `hash` is known. The hash is passed in, as computing it would sort
+    // the set.
+    bool checkValid(TxSetFrame const& txSet, Hash const& hash);
+
+    // Whether `tx` was found valid (with some `current`).
+    bool isKnownValid(TransactionFrame const& tx);
+};
+}
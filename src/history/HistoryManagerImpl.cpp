@@ -484,6 +484,10 @@ HistoryManagerImpl::queueCurrentHistory()
 
     auto ledger = has.currentLedger;
     CLOG(DEBUG, "History") << "Queueing publish state for ledger " << ledger;
+
+    // A queued state must be publishable after a restart, so any of its
+    // buckets that are only held in memory get written out now.
+    mApp.getBucketManager().persistBuckets(has.allBuckets());
     auto state = has.toString();
     auto timer = mApp.getDatabase().getInsertTimer("publishqueue");
     auto prep = mApp.getDatabase().getPreparedStatement(
@@ -55,7 +55,8 @@ StateSnapshot::makeLive()
         auto& hb = mLocalState.currentBuckets[i];
         if (hb.next.hasHashes() && !hb.next.isLive())
         {
-            hb.next.makeLive(mApp, BucketList::keepDeadEntries(i));
+            hb.next.makeLive(mApp, BucketList::keepDeadEntries(i),
+                             BucketList::keepInMemory(mApp, i));
         }
     }
 }
@@ -65,6 +65,7 @@ PutSnapshotFilesWork::onSuccess()
 
         std::vector<std::string> bucketsToSend =
             mSnapshot->mLocalState.differingBuckets(mRemoteState);
+        mApp.getBucketManager().persistBuckets(bucketsToSend);
 
         for (auto const& hash : bucketsToSend)
         {
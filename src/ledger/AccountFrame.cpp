@@ -8,11 +8,13 @@
 #include "crypto/KeyUtils.h"
 #include "crypto/SecretKey.h"
 #include "crypto/SignerKey.h"
+#include "database/BulkTableWriter.h"
 #include "database/Database.h"
 #include "ledger/LedgerManager.h"
 #include "ledger/LedgerRange.h"
 #include "lib/util/format.h"
 #include "util/basen.h"
+#include "util/make_unique.h"
 #include "util/types.h"
 #include <algorithm>
 
@@ -282,6 +284,108 @@ AccountFrame::loadAccount(AccountID const& accountID, Database& db)
     return res;
 }
 
+void
+AccountFrame::prefetchAccounts(std::vector<LedgerKey> const& keys,
+                               Database& db)
+{
+    std::vector<AccountID> accountIDs;
+    for (auto const& k : keys)
+    {
+        accountIDs.emplace_back(k.account().accountID);
+    }
+    std::string idList = accountIDList(accountIDs);
+
+    std::map<std::string, AccountFrame::pointer> loaded;
+    std::vector<AccountID> withSigners;
+    {
+        std::string actIDStrKey, inflationDest, homeDomain, thresholds;
+        soci::indicator inflationDestInd;
+        AccountEntry account;
+        uint32_t lastModified;
+
+        auto prep = db.getUncachedStatement(
+            "SELECT accountid, balance, seqnum, numsubentries, "
+            "inflationdest, homedomain, thresholds, flags, lastmodified "
+            "FROM accounts WHERE accountid IN (" +
+            idList + ")");
+        auto& st = prep.statement();
+        st.exchange(into(actIDStrKey));
+        st.exchange(into(account.balance));
+        st.exchange(into(account.seqNum));
+        st.exchange(into(account.numSubEntries));
+        st.exchange(into(inflationDest, inflationDestInd));
+        st.exchange(into(homeDomain));
+        st.exchange(into(thresholds));
+        st.exchange(into(account.flags));
+        st.exchange(into(lastModified));
+        st.define_and_bind();
+
+        auto timer = db.getSelectTimer("account-prefetch");
+        st.execute(true);
+        while (st.got_data())
+        {
+            auto res = make_shared<AccountFrame>();
+            auto& a = res->getAccount();
+            a = account;
+            a.accountID = KeyUtils::fromStrKey<PublicKey>(actIDStrKey);
+            a.homeDomain = homeDomain;
+            bn::decode_b64(thresholds.begin(), thresholds.end(),
+                           a.thresholds.begin());
+            if (inflationDestInd == soci::i_ok)
+            {
+                a.inflationDest.activate() =
+                    KeyUtils::fromStrKey<PublicKey>(inflationDest);
+            }
+            res->getLastModified() = lastModified;
+            if (a.numSubEntries != 0)
+            {
+                withSigners.emplace_back(a.accountID);
+            }
+            loaded.emplace(actIDStrKey, res);
+            st.fetch();
+        }
+    }
+
+    if (!withSigners.empty())
+    {
+        std::string actIDStrKey, pubKey;
+        Signer signer;
+
+        auto prep = db.getUncachedStatement(
+            "SELECT accountid, publickey, weight FROM signers "
+            "WHERE accountid IN (" +
+            accountIDList(withSigners) + ")");
+        auto& st = prep.statement();
+        st.exchange(into(actIDStrKey));
+        st.exchange(into(pubKey));
+        st.exchange(into(signer.weight));
+        st.define_and_bind();
+
+        auto timer = db.getSelectTimer("signer-prefetch");
+        st.execute(true);
+        while (st.got_data())
+        {
+            signer.key = KeyUtils::fromStrKey<SignerKey>(pubKey);
+            loaded.at(actIDStrKey)->getAccount().signers.push_back(signer);
+            st.fetch();
+        }
+    }
+
+    for (auto const& l : loaded)
+    {
+        l.second->normalize();
+        l.second->putCachedEntry(db);
+    }
+    for (auto const& k : keys)
+    {
+        if (loaded.find(KeyUtils::toStrKey(k.account().accountID)) ==
+            loaded.end())
+        {
+            putCachedEntry(k, nullptr, db);
+        }
+    }
+}
+
 std::vector<Signer>
 AccountFrame::loadSigners(Database& db, std::string const& actIDStrKey)
 {
@@ -315,9 +419,9 @@ AccountFrame::loadSigners(Database& db, std::string const& actIDStrKey)
 bool
 AccountFrame::exists(Database& db, LedgerKey const& key)
 {
-    if (cachedEntryExists(key, db) && getCachedEntry(key, db) != nullptr)
+    if (cachedEntryExists(key, db))
     {
-        return true;
+        return getCachedEntry(key, db) != nullptr;
     }
 
     std::string actIDStrKey = KeyUtils::toStrKey(key.account().accountID);
@@ -333,6 +437,10 @@ AccountFrame::exists(Database& db, LedgerKey const& key)
         st.define_and_bind();
         st.execute(true);
     }
+    if (exists == 0)
+    {
+        putCachedEntry(key, nullptr, db);
+    }
     return exists != 0;
 }
 
@@ -711,6 +819,83 @@ AccountFrame::checkDB(Database& db)
     return state;
 }
 
+std::unique_ptr<BulkTableWriter>
+AccountFrame::makeBulkWriter(Database& db)
+{
+    return make_unique<BulkTableWriter>(
+        db, "accounts",
+        std::vector<std::string>{"accountid", "balance", "seqnum",
+                                 "numsubentries", "inflationdest",
+                                 "homedomain", "thresholds", "flags",
+                                 "lastmodified"},
+        std::vector<std::string>{"accountid"},
+        std::vector<std::string>{"accountid"});
+}
+
+std::unique_ptr<BulkTableWriter>
+AccountFrame::makeBulkSignersWriter(Database& db)
+{
+    // Signers are replaced wholesale: erasing by account drops the old set.
+    return make_unique<BulkTableWriter>(
+        db, "signers",
+        std::vector<std::string>{"accountid", "publickey", "weight"},
+        std::vector<std::string>{"accountid", "publickey"},
+        std::vector<std::string>{"accountid"});
+}
+
+void
+AccountFrame::bulkUpsert(BulkTableWriter& accounts, BulkTableWriter& signers,
+                         LedgerEntry const& entry)
+{
+    auto const& account = entry.data.account();
+    std::string actIDStrKey = KeyUtils::toStrKey(account.accountID);
+
+    accounts.upsert(
+        {BulkValue::text(actIDStrKey), BulkValue::integer(account.balance),
+         BulkValue::integer(account.seqNum),
+         BulkValue::integer(account.numSubEntries),
+         account.inflationDest
+             ? BulkValue::text(KeyUtils::toStrKey(*account.inflationDest))
+             : BulkValue::null(),
+         BulkValue::text(account.homeDomain),
+         BulkValue::text(bn::encode_b64(account.thresholds)),
+         BulkValue::integer(account.flags),
+         BulkValue::integer(entry.lastModifiedLedgerSeq)});
+
+    signers.erase({BulkValue::text(actIDStrKey)});
+    for (auto const& s : account.signers)
+    {
+        signers.upsert({BulkValue::text(actIDStrKey),
+                        BulkValue::text(KeyUtils::toStrKey(s.key)),
+                        BulkValue::integer(s.weight)});
+    }
+}
+
+void
+AccountFrame::bulkErase(BulkTableWriter& accounts, BulkTableWriter& signers,
+                        LedgerKey const& key)
+{
+    std::string actIDStrKey = KeyUtils::toStrKey(key.account().accountID);
+    accounts.erase({BulkValue::text(actIDStrKey)});
+    signers.erase({BulkValue::text(actIDStrKey)});
+}
+
+void
+AccountFrame::dropSecondaryIndexes(Database& db)
+{
+    db.getSession() << "DROP INDEX IF EXISTS signersaccount;";
+    db.getSession() << "DROP INDEX IF EXISTS accountbalances;";
+}
+
+void
+AccountFrame::createSecondaryIndexes(Database& db)
+{
+    db.getSession() << "CREATE INDEX IF NOT EXISTS signersaccount "
+                       "ON signers (accountid)";
+    db.getSession() << "CREATE INDEX IF NOT EXISTS accountbalances "
+                       "ON accounts (balance) WHERE balance >= 1000000000";
+}
+
 void
 AccountFrame::dropAll(Database& db)
 {
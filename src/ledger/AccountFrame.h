@@ -20,6 +20,7 @@ class prepare_temp_type;
 
 namespace stellar
 {
+class BulkTableWriter;
 class LedgerManager;
 class LedgerRange;
 
@@ -131,6 +132,11 @@ class AccountFrame : public EntryFrame
     static AccountFrame::pointer loadAccount(AccountID const& accountID,
                                              Database& db);
 
+    // loads the requested entries into the entry cache, see
+    // EntryFrame::prefetch
+    static void prefetchAccounts(std::vector<LedgerKey> const& keys,
+                                 Database& db);
+
     // compare signers, ignores weight
     static bool signerCompare(Signer const& s1, Signer const& s2);
 
@@ -151,6 +157,21 @@ class AccountFrame : public EntryFrame
     static std::unordered_map<AccountID, AccountFrame::pointer>
     checkDB(Database& db);
 
+    // bulk-loading helpers, used when applying buckets: writers for the
+    // accounts and signers tables, and how entries and keys map onto them
+    static std::unique_ptr<BulkTableWriter> makeBulkWriter(Database& db);
+    static std::unique_ptr<BulkTableWriter> makeBulkSignersWriter(Database& db);
+    static void bulkUpsert(BulkTableWriter& accounts, BulkTableWriter& signers,
+                           LedgerEntry const& entry);
+    static void bulkErase(BulkTableWriter& accounts, BulkTableWriter& signers,
+                          LedgerKey const& key);
+
+    // indexes that are not needed to enforce uniqueness, and can be dropped
+    // while bulk-loading into empty tables and rebuilt afterwards; creating
+    // them is a no-op if they exist
+    static void dropSecondaryIndexes(Database& db);
+    static void createSecondaryIndexes(Database& db);
+
     static void dropAll(Database& db);
 
   private:
@@ -7,10 +7,12 @@
 #include "crypto/KeyUtils.h"
 #include "crypto/SHA.h"
 #include "crypto/SecretKey.h"
+#include "database/BulkTableWriter.h"
 #include "database/Database.h"
 #include "ledger/LedgerRange.h"
 #include "transactions/ManageDataOpFrame.h"
 #include "util/basen.h"
+#include "util/make_unique.h"
 #include "util/types.h"
 
 using namespace std;
@@ -77,6 +79,16 @@ DataFrame::pointer
 DataFrame::loadData(AccountID const& accountID, std::string dataName,
                     Database& db)
 {
+    LedgerKey key;
+    key.type(DATA);
+    key.data().accountID = accountID;
+    key.data().dataName = dataName;
+    if (cachedEntryExists(key, db))
+    {
+        auto p = getCachedEntry(key, db);
+        return p ? std::make_shared<DataFrame>(*p) : nullptr;
+    }
+
     DataFrame::pointer retData;
 
     std::string actIDStrKey = KeyUtils::toStrKey(accountID);
@@ -93,6 +105,14 @@ DataFrame::loadData(AccountID const& accountID, std::string dataName,
         retData = make_shared<DataFrame>(data);
     });
 
+    if (retData)
+    {
+        retData->putCachedEntry(db);
+    }
+    else
+    {
+        putCachedEntry(key, nullptr, db);
+    }
     return retData;
 }
 
@@ -134,6 +154,36 @@ DataFrame::loadData(StatementContext& prep,
     }
 }
 
+void
+DataFrame::prefetchData(std::vector<LedgerKey> const& keys, Database& db)
+{
+    std::set<LedgerKey, LedgerEntryIdCmp> missing(keys.begin(), keys.end());
+    std::vector<AccountID> accountIDs;
+    for (auto const& k : keys)
+    {
+        accountIDs.emplace_back(k.data().accountID);
+    }
+
+    // Loads all the data entries of the accounts involved, and keeps the ones
+    // asked for.
+    std::string sql = dataColumnSelector;
+    sql += " WHERE accountid IN (" + accountIDList(accountIDs) + ")";
+    auto prep = db.getUncachedStatement(sql);
+
+    auto timer = db.getSelectTimer("data-prefetch");
+    loadData(prep, [&missing, &db](LedgerEntry const& data) {
+        auto key = LedgerEntryKey(data);
+        if (missing.erase(key) != 0)
+        {
+            putCachedEntry(key, make_shared<LedgerEntry const>(data), db);
+        }
+    });
+    for (auto const& k : missing)
+    {
+        putCachedEntry(k, nullptr, db);
+    }
+}
+
 std::unordered_map<AccountID, std::vector<DataFrame::pointer>>
 DataFrame::loadAllData(Database& db)
 {
@@ -153,6 +203,11 @@ DataFrame::loadAllData(Database& db)
 bool
 DataFrame::exists(Database& db, LedgerKey const& key)
 {
+    if (cachedEntryExists(key, db))
+    {
+        return getCachedEntry(key, db) != nullptr;
+    }
+
     std::string actIDStrKey = KeyUtils::toStrKey(key.data().accountID);
     std::string dataName = key.data().dataName;
     int exists = 0;
@@ -166,6 +221,10 @@ DataFrame::exists(Database& db, LedgerKey const& key)
     st.exchange(into(exists));
     st.define_and_bind();
     st.execute(true);
+    if (exists == 0)
+    {
+        putCachedEntry(key, nullptr, db);
+    }
     return exists != 0;
 }
 
@@ -216,6 +275,8 @@ DataFrame::storeDelete(LedgerDelta& delta, Database& db) const
 void
 DataFrame::storeDelete(LedgerDelta& delta, Database& db, LedgerKey const& key)
 {
+    flushCachedEntry(key, db);
+
     std::string actIDStrKey = KeyUtils::toStrKey(key.data().accountID);
     std::string dataName = key.data().dataName;
     auto timer = db.getDeleteTimer("data");
@@ -244,6 +305,8 @@ DataFrame::storeAdd(LedgerDelta& delta, Database& db)
 void
 DataFrame::storeUpdateHelper(LedgerDelta& delta, Database& db, bool insert)
 {
+    flushCachedEntry(db);
+
     touch(delta);
 
     std::string actIDStrKey = KeyUtils::toStrKey(mData.accountID);
@@ -290,6 +353,34 @@ DataFrame::storeUpdateHelper(LedgerDelta& delta, Database& db, bool insert)
     }
 }
 
+std::unique_ptr<BulkTableWriter>
+DataFrame::makeBulkWriter(Database& db)
+{
+    return make_unique<BulkTableWriter>(
+        db, "accountdata",
+        std::vector<std::string>{"accountid", "dataname", "datavalue",
+                                 "lastmodified"},
+        std::vector<std::string>{"accountid", "dataname"},
+        std::vector<std::string>{"accountid", "dataname"});
+}
+
+void
+DataFrame::bulkUpsert(BulkTableWriter& data, LedgerEntry const& entry)
+{
+    auto const& d = entry.data.data();
+    data.upsert({BulkValue::text(KeyUtils::toStrKey(d.accountID)),
+                 BulkValue::text(d.dataName),
+                 BulkValue::text(bn::encode_b64(d.dataValue)),
+                 BulkValue::integer(entry.lastModifiedLedgerSeq)});
+}
+
+void
+DataFrame::bulkErase(BulkTableWriter& data, LedgerKey const& key)
+{
+    data.erase({BulkValue::text(KeyUtils::toStrKey(key.data().accountID)),
+                BulkValue::text(key.data().dataName)});
+}
+
 void
 DataFrame::dropAll(Database& db)
 {
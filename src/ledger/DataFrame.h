@@ -15,6 +15,7 @@ class session;
 
 namespace stellar
 {
+class BulkTableWriter;
 class LedgerRange;
 class ManageDataOpFrame;
 class StatementContext;
@@ -78,10 +79,19 @@ class DataFrame : public EntryFrame
     static pointer loadData(AccountID const& accountID, std::string dataName,
                             Database& db);
 
+    // loads the requested entries into the entry cache, see
+    // EntryFrame::prefetch
+    static void prefetchData(std::vector<LedgerKey> const& keys, Database& db);
+
     // load all data entries from the database (very slow)
     static std::unordered_map<AccountID, std::vector<DataFrame::pointer>>
     loadAllData(Database& db);
 
+    // bulk-loading helpers, used when applying buckets
+    static std::unique_ptr<BulkTableWriter> makeBulkWriter(Database& db);
+    static void bulkUpsert(BulkTableWriter& data, LedgerEntry const& entry);
+    static void bulkErase(BulkTableWriter& data, LedgerKey const& key);
+
     static void dropAll(Database& db);
 
   private:
@@ -4,7 +4,7 @@
 
 #include "ledger/EntryFrame.h"
 #include "LedgerManager.h"
-#include "crypto/Hex.h"
+#include "crypto/KeyUtils.h"
 #include "database/Database.h"
 #include "ledger/AccountFrame.h"
 #include "ledger/DataFrame.h"
@@ -13,11 +13,16 @@
 #include "ledger/TrustFrame.h"
 #include "xdrpp/marshal.h"
 #include "xdrpp/printer.h"
+#include <algorithm>
+#include <functional>
 
 namespace stellar
 {
 using xdr::operator==;
 
+// Number of keys of one type loaded by a single prefetch query.
+static size_t const kPrefetchBatchSize = 512;
+
 EntryFrame::pointer
 EntryFrame::FromXDR(LedgerEntry const& from)
 {
@@ -109,30 +114,72 @@ EntryFrame::touch(LedgerDelta const& delta)
 void
 EntryFrame::flushCachedEntry(LedgerKey const& key, Database& db)
 {
-    auto s = binToHex(xdr::xdr_to_opaque(key));
-    db.getEntryCache().erase_if_exists(s);
+    db.getEntryCache().erase(key);
 }
 
 bool
 EntryFrame::cachedEntryExists(LedgerKey const& key, Database& db)
 {
-    auto s = binToHex(xdr::xdr_to_opaque(key));
-    return db.getEntryCache().exists(s);
+    return db.getEntryCache().exists(key);
 }
 
 std::shared_ptr<LedgerEntry const>
 EntryFrame::getCachedEntry(LedgerKey const& key, Database& db)
 {
-    auto s = binToHex(xdr::xdr_to_opaque(key));
-    return db.getEntryCache().get(s);
+    return db.getEntryCache().get(key);
 }
 
 void
 EntryFrame::putCachedEntry(LedgerKey const& key,
                            std::shared_ptr<LedgerEntry const> p, Database& db)
 {
-    auto s = binToHex(xdr::xdr_to_opaque(key));
-    db.getEntryCache().put(s, p);
+    db.getEntryCache().put(key, p);
+}
+
+void
+EntryFrame::prefetch(std::set<LedgerKey, LedgerEntryIdCmp> const& keys,
+                     Database& db)
+{
+    std::vector<LedgerKey> accounts, trustLines, data;
+    for (auto const& key : keys)
+    {
+        if (db.getEntryCache().exists(key, false))
+        {
+            continue;
+        }
+        switch (key.type())
+        {
+        case ACCOUNT:
+            accounts.emplace_back(key);
+            break;
+        case TRUSTLINE:
+            trustLines.emplace_back(key);
+            break;
+        case DATA:
+            data.emplace_back(key);
+            break;
+        default:
+            break;
+        }
+    }
+
+    auto batches = [](std::vector<LedgerKey> const& all,
+                      std::function<void(std::vector<LedgerKey> const&)> f) {
+        for (size_t i = 0; i < all.size(); i += kPrefetchBatchSize)
+        {
+            auto end = std::min(all.size(), i + kPrefetchBatchSize);
+            f(std::vector<LedgerKey>(all.begin() + i, all.begin() + end));
+        }
+    };
+    batches(accounts, [&db](std::vector<LedgerKey> const& batch) {
+        AccountFrame::prefetchAccounts(batch, db);
+    });
+    batches(trustLines, [&db](std::vector<LedgerKey> const& batch) {
+        TrustFrame::prefetchTrustLines(batch, db);
+    });
+    batches(data, [&db](std::vector<LedgerKey> const& batch) {
+        DataFrame::prefetchData(batch, db);
+    });
 }
 
 void
@@ -279,4 +326,51 @@ LedgerEntryKey(LedgerEntry const& e)
     }
     return k;
 }
+
+LedgerKey
+accountKey(AccountID const& accountID)
+{
+    LedgerKey k;
+    k.type(ACCOUNT);
+    k.account().accountID = accountID;
+    return k;
+}
+
+LedgerKey
+trustLineKey(AccountID const& accountID, Asset const& asset)
+{
+    LedgerKey k;
+    k.type(TRUSTLINE);
+    k.trustLine().accountID = accountID;
+    k.trustLine().asset = asset;
+    return k;
+}
+
+LedgerKey
+dataKey(AccountID const& accountID, std::string const& dataName)
+{
+    LedgerKey k;
+    k.type(DATA);
+    k.data().accountID = accountID;
+    k.data().dataName = dataName;
+    return k;
+}
+
+std::string
+accountIDList(std::vector<AccountID> const& accountIDs)
+{
+    // StrKeys are base32, so need no escaping.
+    std::string res;
+    for (auto const& id : accountIDs)
+    {
+        if (!res.empty())
+        {
+            res += ',';
+        }
+        res += '\'';
+        res += KeyUtils::toStrKey(id);
+        res += '\'';
+    }
+    return res;
+}
 }
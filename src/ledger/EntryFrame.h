@@ -7,6 +7,8 @@
 #include "bucket/LedgerCmp.h"
 #include "overlay/StellarXDR.h"
 #include "util/NonCopyable.h"
+#include <set>
+#include <vector>
 
 /*
 Frame
@@ -51,6 +53,12 @@ class EntryFrame : public NonMovableOrCopyable
                                std::shared_ptr<LedgerEntry const> p,
                                Database& db);
 
+    // Load the entries for all `keys` that are not already cached into the
+    // cache (or their absence), with a few batched queries per entry type
+    // rather than one query per key. Offers are not prefetched.
+    static void prefetch(std::set<LedgerKey, LedgerEntryIdCmp> const& keys,
+                         Database& db);
+
     // helpers to get/set the last modified field
     uint32 getLastModified() const;
     uint32& getLastModified();
@@ -83,4 +91,13 @@ class EntryFrame : public NonMovableOrCopyable
 
 // static helper for getting a LedgerKey from a LedgerEntry.
 LedgerKey LedgerEntryKey(LedgerEntry const& e);
+
+// static helpers for building the LedgerKey of an entry of each type.
+LedgerKey accountKey(AccountID const& accountID);
+LedgerKey trustLineKey(AccountID const& accountID, Asset const& asset);
+LedgerKey dataKey(AccountID const& accountID, std::string const& dataName);
+
+// static helper for building the `IN (...)` list of a query matching
+// `accountIDs`.
+std::string accountIDList(std::vector<AccountID> const& accountIDs);
 }
@@ -12,6 +12,8 @@
 #include "ledger/LedgerTestUtils.h"
 #include "lib/catch.hpp"
 #include "main/Application.h"
+#include "medida/meter.h"
+#include "medida/metrics_registry.h"
 #include "test/TestUtils.h"
 #include "test/test.h"
 #include "util/Logging.h"
@@ -19,6 +21,7 @@
 #include "xdrpp/autocheck.h"
 #include "xdrpp/marshal.h"
 #include <memory>
+#include <set>
 #include <unordered_map>
 #include <utility>
 
@@ -273,5 +276,100 @@ TEST_CASE("Ledger Entry tests", "[ledgerentry]")
 
         app->getLedgerManager().checkDbState();
     }
+
+    SECTION("prefetch")
+    {
+        std::set<LedgerKey, LedgerEntryIdCmp> keys;
+        std::vector<LedgerEntry> entries;
+        for (int i = 0; i < 10; i++)
+        {
+            LedgerEntry acc;
+            acc.data.type(ACCOUNT);
+            acc.data.account() = LedgerTestUtils::generateValidAccountEntry(5);
+            LedgerEntry tl;
+            tl.data.type(TRUSTLINE);
+            tl.data.trustLine() =
+                LedgerTestUtils::generateValidTrustLineEntry(5);
+            tl.data.trustLine().accountID = acc.data.account().accountID;
+            LedgerEntry data;
+            data.data.type(DATA);
+            data.data.data() = LedgerTestUtils::generateValidDataEntry(5);
+            data.data.data().accountID = acc.data.account().accountID;
+            entries.insert(entries.end(), {acc, tl, data});
+        }
+
+        LedgerHeader lh;
+        LedgerDelta delta(lh, db, false);
+        for (auto const& le : entries)
+        {
+            keys.emplace(LedgerEntryKey(le));
+            // every other entry is left absent
+            if (keys.size() % 2 == 0)
+            {
+                EntryFrame::FromXDR(le)->storeAdd(delta, db);
+            }
+        }
+
+        db.getEntryCache().clear();
+        EntryFrame::prefetch(keys, db);
+        for (auto const& key : keys)
+        {
+            REQUIRE(db.getEntryCache().exists(key, false));
+            auto cached = db.getEntryCache().get(key);
+            EntryFrame::flushCachedEntry(key, db);
+            auto fromDb = EntryFrame::storeLoad(key, db);
+            REQUIRE(!cached == !fromDb);
+            if (fromDb)
+            {
+                REQUIRE(*cached == fromDb->mEntry);
+            }
+        }
+    }
+
+    SECTION("absent entries are cached")
+    {
+        LedgerEntry acc;
+        acc.data.type(ACCOUNT);
+        acc.data.account() = LedgerTestUtils::generateValidAccountEntry(5);
+        LedgerEntry tl;
+        tl.data.type(TRUSTLINE);
+        tl.data.trustLine() = LedgerTestUtils::generateValidTrustLineEntry(5);
+        LedgerEntry data;
+        data.data.type(DATA);
+        data.data.data() = LedgerTestUtils::generateValidDataEntry(5);
+
+        for (auto const& le : {acc, tl, data})
+        {
+            auto key = LedgerEntryKey(le);
+            auto typeName = xdr::xdr_traits<LedgerEntryType>::enum_name(
+                le.data.type());
+            auto& negativeHits = app->getMetrics().NewMeter(
+                {"entry-cache", typeName, "negative-hit"}, "lookup");
+
+            auto before = negativeHits.count();
+            REQUIRE(!EntryFrame::exists(db, key));
+            REQUIRE(!EntryFrame::storeLoad(key, db));
+            REQUIRE(!EntryFrame::exists(db, key));
+            REQUIRE(negativeHits.count() == before + 2);
+
+            LedgerHeader lh;
+            {
+                // a rolled back addition leaves the entry absent
+                soci::transaction tx(db.getSession());
+                LedgerDelta delta(lh, db, false);
+                EntryFrame::FromXDR(le)->storeAdd(delta, db);
+                REQUIRE(EntryFrame::exists(db, key));
+                delta.rollback();
+                tx.rollback();
+                REQUIRE(!EntryFrame::exists(db, key));
+            }
+            {
+                LedgerDelta delta(lh, db, false);
+                EntryFrame::FromXDR(le)->storeAdd(delta, db);
+                REQUIRE(EntryFrame::exists(db, key));
+                REQUIRE(EntryFrame::storeLoad(key, db));
+            }
+        }
+    }
 }
 }
@@ -113,6 +113,10 @@ LedgerManagerImpl::LedgerManagerImpl(Application& app)
     : mApp(app)
     , mTransactionApply(
           app.getMetrics().NewTimer({"ledger", "transaction", "apply"}))
+    , mTransactionPrefetch(
+          app.getMetrics().NewTimer({"ledger", "transaction", "prefetch"}))
+    , mTransactionVerifySignatures(app.getMetrics().NewTimer(
+          {"ledger", "transaction", "verify-signatures"}))
     , mLedgerClose(app.getMetrics().NewTimer({"ledger", "ledger", "close"}))
     , mLedgerAgeClosed(app.getMetrics().NewTimer({"ledger", "age", "closed"}))
     , mLedgerAge(
@@ -278,6 +282,16 @@ LedgerManagerImpl::loadLastKnownLedger(
                     << mApp.getBucketManager().getBucketDir() << "'.";
                 CLOG(WARNING, "Ledger")
                     << "Attempting to recover from the history store.";
+                if (mApp.getConfig().BUCKETLIST_IN_MEMORY_LEVELS != 0)
+                {
+                    // their files are not synced, and were lost if the
+                    // machine crashed; those not published yet can't be
+                    // downloaded either
+                    CLOG(WARNING, "Ledger")
+                        << "Buckets of BUCKETLIST_IN_MEMORY_LEVELS may not be "
+                        << "recoverable; if this fails, run with --newdb and "
+                        << "catch up.";
+                }
                 mApp.getHistoryManager().downloadMissingBuckets(has,
                                                                 continuation);
             }
@@ -727,6 +741,17 @@ LedgerManagerImpl::closeLedger(LedgerCloseData const& ledgerData)
     // sorted such that sequence numbers are respected
     vector<TransactionFramePtr> txs = ledgerData.getTxSet()->sortForApply();
 
+    // load the entries the transactions are known to need in a few batches,
+    // rather than one query at a time as they're applied
+    prefetchTransactionData(txs);
+
+    // check the signatures in parallel, usually already done when the set
+    // was received, so that applying finds them in the signature cache
+    {
+        auto timer = mTransactionVerifySignatures.TimeScope();
+        ledgerData.getTxSet()->verifySignatures(mApp);
+    }
+
     // first, charge fees
     processFeesSeqNums(txs, ledgerDelta);
 
@@ -783,6 +808,7 @@ LedgerManagerImpl::closeLedger(LedgerCloseData const& ledgerData)
     // step 2
     mApp.getDatabase().clearPreparedStatementCache();
     txscope.commit();
+    getDatabase().getOrderBook().checkpoint();
 
     // step 3
     hm.publishQueuedHistory();
@@ -880,6 +906,19 @@ LedgerManagerImpl::advanceLedgerPointers()
                           << mCurrentLedger->mHeader.ledgerSeq;
 }
 
+void
+LedgerManagerImpl::prefetchTransactionData(
+    std::vector<TransactionFramePtr>& txs)
+{
+    auto timer = mTransactionPrefetch.TimeScope();
+    std::set<LedgerKey, LedgerEntryIdCmp> keys;
+    for (auto const& tx : txs)
+    {
+        tx->insertLedgerKeysToPrefetch(keys);
+    }
+    EntryFrame::prefetch(keys, getDatabase());
+}
+
 void
 LedgerManagerImpl::processFeesSeqNums(std::vector<TransactionFramePtr>& txs,
                                       LedgerDelta& delta)
@@ -978,6 +1017,10 @@ LedgerManagerImpl::storeCurrentLedger()
         has.resolveAnyReadyFutures();
     }
 
+    // the state is only stored once the buckets it names are all on disk,
+    // which in-memory buckets may not be yet
+    mApp.getBucketManager().writeBucketFiles(has.allBuckets());
+
     mApp.getPersistentState().setState(PersistentState::kHistoryArchiveState,
                                        has.toString());
 }
@@ -40,6 +40,8 @@ class LedgerManagerImpl : public LedgerManager
 
     Application& mApp;
     medida::Timer& mTransactionApply;
+    medida::Timer& mTransactionPrefetch;
+    medida::Timer& mTransactionVerifySignatures;
     medida::Timer& mLedgerClose;
     medida::Timer& mLedgerAgeClosed;
     medida::Counter& mLedgerAge;
@@ -56,6 +58,7 @@ class LedgerManagerImpl : public LedgerManager
                          CatchupWork::ProgressState progressState,
                          LedgerHeaderHistoryEntry const& lastClosed);
 
+    void prefetchTransactionData(std::vector<TransactionFramePtr>& txs);
     void processFeesSeqNums(std::vector<TransactionFramePtr>& txs,
                             LedgerDelta& delta);
     void applyTransactions(std::vector<TransactionFramePtr>& txs,
@@ -7,9 +7,11 @@
 #include "crypto/KeyUtils.h"
 #include "crypto/SHA.h"
 #include "crypto/SecretKey.h"
+#include "database/BulkTableWriter.h"
 #include "database/Database.h"
 #include "ledger/LedgerRange.h"
 #include "transactions/ManageOfferOpFrame.h"
+#include "util/make_unique.h"
 #include "util/types.h"
 
 using namespace std;
@@ -240,10 +242,30 @@ OfferFrame::loadOffers(StatementContext& prep,
     }
 }
 
+OfferFrame::pointer
+OfferFrame::loadBestOffer(Asset const& selling, Asset const& buying,
+                          Database& db, OfferFrame const* after)
+{
+    auto& orderBook = db.getOrderBook();
+    if (!orderBook.isLoaded(selling, buying))
+    {
+        std::vector<LedgerEntry> offers;
+        loadOffers(selling, buying, offers, db);
+        orderBook.load(selling, buying, offers);
+    }
+
+    OrderBook::OfferOrder afterOrder;
+    if (after)
+    {
+        afterOrder = OrderBook::getOrder(after->mOffer);
+    }
+    auto best = orderBook.next(selling, buying, after ? &afterOrder : nullptr);
+    return best ? make_shared<OfferFrame>(*best) : nullptr;
+}
+
 void
-OfferFrame::loadBestOffers(size_t numOffers, size_t offset,
-                           Asset const& selling, Asset const& buying,
-                           vector<OfferFrame::pointer>& retOffers, Database& db)
+OfferFrame::loadOffers(Asset const& selling, Asset const& buying,
+                       std::vector<LedgerEntry>& retOffers, Database& db)
 {
     std::string sql = offerColumnSelector;
 
@@ -305,10 +327,6 @@ OfferFrame::loadBestOffers(size_t numOffers, size_t offset,
         sql += " AND buyingassetcode = :gcur AND buyingissuer = :gi";
     }
 
-    // price is an approximation of the actual n/d (truncated math, 15 digits)
-    // ordering by offerid gives precendence to older offers for fairness
-    sql += " ORDER BY price, offerid LIMIT :n OFFSET :o";
-
     auto prep = db.getPreparedStatement(sql);
     auto& st = prep.statement();
 
@@ -324,12 +342,9 @@ OfferFrame::loadBestOffers(size_t numOffers, size_t offset,
         st.exchange(use(buyingIssuerStrKey));
     }
 
-    st.exchange(use(numOffers));
-    st.exchange(use(offset));
-
     auto timer = db.getSelectTimer("offer");
     loadOffers(prep, [&retOffers](LedgerEntry const& of) {
-        retOffers.emplace_back(make_shared<OfferFrame>(of));
+        retOffers.emplace_back(of);
     });
 }
 
@@ -394,6 +409,7 @@ OfferFrame::deleteOffersModifiedOnOrAfterLedger(Database& db,
             return le && le->data.type() == OFFER &&
                    le->lastModifiedLedgerSeq >= oldestLedger;
         });
+    db.getOrderBook().clear();
 
     {
         auto prep = db.getPreparedStatement(
@@ -408,6 +424,7 @@ OfferFrame::deleteOffersModifiedOnOrAfterLedger(Database& db,
 void
 OfferFrame::storeDelete(LedgerDelta& delta, Database& db) const
 {
+    db.getOrderBook().erase(mOffer);
     storeDelete(delta, db, getKey());
 }
 
@@ -420,6 +437,7 @@ OfferFrame::storeDelete(LedgerDelta& delta, Database& db, LedgerKey const& key)
     st.exchange(use(key.offer().offerID));
     st.define_and_bind();
     st.execute(true);
+    db.getOrderBook().erase(key.offer().offerID);
     delta.deleteEntry(key);
 }
 
@@ -535,6 +553,8 @@ OfferFrame::storeUpdateHelper(LedgerDelta& delta, Database& db, bool insert)
         throw std::runtime_error("could not update SQL");
     }
 
+    db.getOrderBook().upsert(mEntry, insert);
+
     if (insert)
     {
         delta.addEntry(*this);
@@ -545,6 +565,90 @@ OfferFrame::storeUpdateHelper(LedgerDelta& delta, Database& db, bool insert)
     }
 }
 
+std::unique_ptr<BulkTableWriter>
+OfferFrame::makeBulkWriter(Database& db)
+{
+    return make_unique<BulkTableWriter>(
+        db, "offers",
+        std::vector<std::string>{
+            "sellerid", "offerid", "sellingassettype", "sellingassetcode",
+            "sellingissuer", "buyingassettype", "buyingassetcode",
+            "buyingissuer", "amount", "pricen", "priced", "price", "flags",
+            "lastmodified"},
+        std::vector<std::string>{"offerid"},
+        std::vector<std::string>{"offerid"});
+}
+
+static void
+addBulkAsset(std::vector<BulkValue>& row, Asset const& asset)
+{
+    row.emplace_back(BulkValue::integer(asset.type()));
+    std::string code;
+    switch (asset.type())
+    {
+    case ASSET_TYPE_CREDIT_ALPHANUM4:
+        assetCodeToStr(asset.alphaNum4().assetCode, code);
+        row.emplace_back(BulkValue::text(code));
+        row.emplace_back(
+            BulkValue::text(KeyUtils::toStrKey(asset.alphaNum4().issuer)));
+        break;
+    case ASSET_TYPE_CREDIT_ALPHANUM12:
+        assetCodeToStr(asset.alphaNum12().assetCode, code);
+        row.emplace_back(BulkValue::text(code));
+        row.emplace_back(
+            BulkValue::text(KeyUtils::toStrKey(asset.alphaNum12().issuer)));
+        break;
+    default:
+        row.emplace_back(BulkValue::null());
+        row.emplace_back(BulkValue::null());
+        break;
+    }
+}
+
+void
+OfferFrame::bulkUpsert(BulkTableWriter& offers, LedgerEntry const& entry)
+{
+    auto const& offer = entry.data.offer();
+    std::vector<BulkValue> row;
+    row.emplace_back(BulkValue::text(KeyUtils::toStrKey(offer.sellerID)));
+    row.emplace_back(BulkValue::integer(offer.offerID));
+    addBulkAsset(row, offer.selling);
+    addBulkAsset(row, offer.buying);
+    row.emplace_back(BulkValue::integer(offer.amount));
+    row.emplace_back(BulkValue::integer(offer.price.n));
+    row.emplace_back(BulkValue::integer(offer.price.d));
+    row.emplace_back(
+        BulkValue::real(double(offer.price.n) / double(offer.price.d)));
+    row.emplace_back(BulkValue::integer(offer.flags));
+    row.emplace_back(BulkValue::integer(entry.lastModifiedLedgerSeq));
+    offers.upsert(std::move(row));
+}
+
+void
+OfferFrame::bulkErase(BulkTableWriter& offers, LedgerKey const& key)
+{
+    offers.erase({BulkValue::integer(key.offer().offerID)});
+}
+
+void
+OfferFrame::dropSecondaryIndexes(Database& db)
+{
+    db.getSession() << "DROP INDEX IF EXISTS sellingissuerindex;";
+    db.getSession() << "DROP INDEX IF EXISTS buyingissuerindex;";
+    db.getSession() << "DROP INDEX IF EXISTS priceindex;";
+}
+
+void
+OfferFrame::createSecondaryIndexes(Database& db)
+{
+    db.getSession() << "CREATE INDEX IF NOT EXISTS sellingissuerindex "
+                       "ON offers (sellingissuer);";
+    db.getSession() << "CREATE INDEX IF NOT EXISTS buyingissuerindex "
+                       "ON offers (buyingissuer);";
+    db.getSession() << "CREATE INDEX IF NOT EXISTS priceindex "
+                       "ON offers (price);";
+}
+
 void
 OfferFrame::dropAll(Database& db)
 {
@@ -15,6 +15,7 @@ class session;
 
 namespace stellar
 {
+class BulkTableWriter;
 class LedgerRange;
 class ManageOfferOpFrame;
 class StatementContext;
@@ -25,6 +26,10 @@ class OfferFrame : public EntryFrame
     loadOffers(StatementContext& prep,
                std::function<void(LedgerEntry const&)> offerProcessor);
 
+    // loads all the offers selling `selling` for `buying`
+    static void loadOffers(Asset const& selling, Asset const& buying,
+                           std::vector<LedgerEntry>& retOffers, Database& db);
+
     double computePrice() const;
 
     OfferEntry& mOffer;
@@ -89,15 +94,26 @@ class OfferFrame : public EntryFrame
     static pointer loadOffer(AccountID const& accountID, uint64_t offerID,
                              Database& db, LedgerDelta* delta = nullptr);
 
-    static void loadBestOffers(size_t numOffers, size_t offset,
-                               Asset const& pays, Asset const& gets,
-                               std::vector<OfferFrame::pointer>& retOffers,
-                               Database& db);
+    // returns the best offer selling `selling` for `buying` that comes
+    // after `after` (if given) in the order offers are crossed in, by price
+    // and then offer ID; or null if there is none. Offers are read from the
+    // Database's OrderBook, which loads the pair's offers on first use.
+    static pointer loadBestOffer(Asset const& selling, Asset const& buying,
+                                 Database& db,
+                                 OfferFrame const* after = nullptr);
 
     // load all offers from the database (very slow)
     static std::unordered_map<AccountID, std::vector<OfferFrame::pointer>>
     loadAllOffers(Database& db);
 
+    // bulk-loading helpers, used when applying buckets
+    static std::unique_ptr<BulkTableWriter> makeBulkWriter(Database& db);
+    static void bulkUpsert(BulkTableWriter& offers, LedgerEntry const& entry);
+    static void bulkErase(BulkTableWriter& offers, LedgerKey const& key);
+    // see AccountFrame::dropSecondaryIndexes
+    static void dropSecondaryIndexes(Database& db);
+    static void createSecondaryIndexes(Database& db);
+
     static void dropAll(Database& db);
 
   private:
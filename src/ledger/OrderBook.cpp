@@ -0,0 +1,255 @@
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "ledger/OrderBook.h"
+#include <algorithm>
+#include <cassert>
+
+namespace stellar
+{
+
+using xdr::operator<;
+using xdr::operator==;
+
+bool
+OrderBook::AssetPairCmp::operator()(AssetPair const& a,
+                                    AssetPair const& b) const
+{
+    if (a.first < b.first)
+    {
+        return true;
+    }
+    if (b.first < a.first)
+    {
+        return false;
+    }
+    return a.second < b.second;
+}
+
+void
+OrderBook::Change::add(AssetPair const& pair)
+{
+    auto same = [&](AssetPair const& p) {
+        return p.first == pair.first && p.second == pair.second;
+    };
+    if (std::find_if(mPairs.begin(), mPairs.end(), same) == mPairs.end())
+    {
+        mPairs.emplace_back(pair);
+    }
+}
+
+OrderBook::OrderBook(size_t maxOffers) : mMaxOffers(maxOffers)
+{
+}
+
+OrderBook::OfferOrder
+OrderBook::getOrder(OfferEntry const& offer)
+{
+    // must match OfferFrame::computePrice, which fills the price column
+    return std::make_pair(double(offer.price.n) / double(offer.price.d),
+                          offer.offerID);
+}
+
+void
+OrderBook::moveOut(uint64_t offerID, OfferLocation const& loc)
+{
+    auto b = mBooks.find(loc.mPair);
+    if (b != mBooks.end())
+    {
+        b->second.mOffers.erase(loc.mOrder);
+    }
+    mChanged[offerID].add(loc.mPair);
+}
+
+void
+OrderBook::dropBook(AssetPair const& pair)
+{
+    auto b = mBooks.find(pair);
+    if (b == mBooks.end())
+    {
+        return;
+    }
+    // changed offers keep their location, as an outer delta's rollback may
+    // need it too
+    for (auto const& o : b->second.mOffers)
+    {
+        if (mChanged.find(o.first.second) == mChanged.end())
+        {
+            mLocations.erase(o.first.second);
+        }
+    }
+    mBooks.erase(b);
+}
+
+void
+OrderBook::makeRoom(AssetPair const& pair, size_t offers)
+{
+    size_t loaded = 0;
+    for (auto const& b : mBooks)
+    {
+        loaded += b.second.mOffers.size();
+    }
+    while (loaded + offers > mMaxOffers)
+    {
+        auto lru = mBooks.end();
+        for (auto b = mBooks.begin(); b != mBooks.end(); ++b)
+        {
+            bool same = b->first.first == pair.first &&
+                        b->first.second == pair.second;
+            if (!same &&
+                (lru == mBooks.end() ||
+                 b->second.mLastUse < lru->second.mLastUse))
+            {
+                lru = b;
+            }
+        }
+        if (lru == mBooks.end())
+        {
+            return;
+        }
+        loaded -= lru->second.mOffers.size();
+        auto victim = lru->first;
+        dropBook(victim);
+    }
+}
+
+bool
+OrderBook::isLoaded(Asset const& selling, Asset const& buying) const
+{
+    return mBooks.find(std::make_pair(selling, buying)) != mBooks.end();
+}
+
+void
+OrderBook::load(Asset const& selling, Asset const& buying,
+                std::vector<LedgerEntry> const& offers)
+{
+    auto pair = std::make_pair(selling, buying);
+    assert(mBooks.find(pair) == mBooks.end());
+    makeRoom(pair, offers.size());
+    auto& loaded = mBooks[pair];
+    loaded.mLastUse = ++mUses;
+    auto& book = loaded.mOffers;
+    for (auto const& le : offers)
+    {
+        auto const& offer = le.data.offer();
+        auto order = getOrder(offer);
+        book.emplace(order, std::make_shared<LedgerEntry const>(le));
+        mLocations[offer.offerID] = OfferLocation{pair, order};
+    }
+}
+
+OrderBook::OfferPtr
+OrderBook::next(Asset const& selling, Asset const& buying,
+                OfferOrder const* after) const
+{
+    auto b = mBooks.find(std::make_pair(selling, buying));
+    assert(b != mBooks.end());
+    b->second.mLastUse = ++mUses;
+    auto const& book = b->second.mOffers;
+    auto it = after ? book.upper_bound(*after) : book.begin();
+    return it == book.end() ? nullptr : it->second;
+}
+
+void
+OrderBook::upsert(LedgerEntry const& le, bool isNew)
+{
+    auto const& offer = le.data.offer();
+    auto loc = mLocations.find(offer.offerID);
+    if (loc != mLocations.end())
+    {
+        moveOut(offer.offerID, loc->second);
+    }
+    else if (!isNew)
+    {
+        // an update can change the offer's pair, and the old one is not
+        // known: its book may be loaded, without the offer, before the
+        // update is rolled back
+        mChanged[offer.offerID].mAnyPair = true;
+    }
+
+    auto pair = std::make_pair(offer.selling, offer.buying);
+    auto order = getOrder(offer);
+    mLocations[offer.offerID] = OfferLocation{pair, order};
+    mChanged[offer.offerID].add(pair);
+
+    auto b = mBooks.find(pair);
+    if (b != mBooks.end())
+    {
+        b->second.mOffers[order] = std::make_shared<LedgerEntry const>(le);
+    }
+}
+
+void
+OrderBook::erase(OfferEntry const& offer)
+{
+    auto loc = mLocations.find(offer.offerID);
+    if (loc != mLocations.end())
+    {
+        moveOut(offer.offerID, loc->second);
+    }
+    // keep the location, in case the deletion is rolled back
+    auto pair = std::make_pair(offer.selling, offer.buying);
+    mLocations[offer.offerID] = OfferLocation{pair, getOrder(offer)};
+    mChanged[offer.offerID].add(pair);
+}
+
+void
+OrderBook::erase(uint64_t offerID)
+{
+    auto loc = mLocations.find(offerID);
+    if (loc != mLocations.end())
+    {
+        moveOut(offerID, loc->second);
+    }
+    else
+    {
+        // the offer's book isn't loaded, but might be loaded before the
+        // deletion is rolled back
+        mChanged[offerID].mAnyPair = true;
+    }
+}
+
+void
+OrderBook::invalidate(uint64_t offerID)
+{
+    auto change = mChanged.find(offerID);
+    if (change == mChanged.end() || change->second.mAnyPair)
+    {
+        clear();
+        return;
+    }
+    for (auto const& pair : change->second.mPairs)
+    {
+        dropBook(pair);
+    }
+}
+
+void
+OrderBook::checkpoint()
+{
+    for (auto const& change : mChanged)
+    {
+        auto loc = mLocations.find(change.first);
+        if (loc == mLocations.end())
+        {
+            continue;
+        }
+        auto b = mBooks.find(loc->second.mPair);
+        if (b == mBooks.end() || b->second.mOffers.find(loc->second.mOrder) ==
+                                     b->second.mOffers.end())
+        {
+            mLocations.erase(loc);
+        }
+    }
+    mChanged.clear();
+}
+
+void
+OrderBook::clear()
+{
+    mBooks.clear();
+    mLocations.clear();
+    mChanged.clear();
+}
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "overlay/StellarXDR.h"
+#include "util/NonCopyable.h"
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace stellar
+{
+
+/**
+ * In-memory index of the offers of some asset pairs, each sorted the way
+ * offers are crossed: by price (as the same double the offers table stores),
+ * then by offer ID. It lets OfferExchange walk a book one offer at a time in
+ * O(log n), rather than re-running an OFFSET query for every page of offers.
+ *
+ * A pair's book is loaded from the database by the first lookup that needs it
+ * and is then kept up to date by OfferFrame's store methods. Since those
+ * changes may still be rolled back, every pair an offer was in since the last
+ * `checkpoint`, before or after a change, is remembered, and `invalidate`
+ * (called by LedgerDelta::rollback) drops the books of all those pairs, to be
+ * reloaded when next needed. Anything that changes offers without going
+ * through OfferFrame must `clear` the order book.
+ *
+ * At most `maxOffers` offers are kept loaded (ORDER_BOOK_MAX_OFFERS): before
+ * a book is loaded, the least recently walked books are dropped until it
+ * fits, or no other book is left. A dropped book is loaded again when next
+ * needed, as the database always holds every stored offer.
+ */
+class OrderBook : NonMovableOrCopyable
+{
+  public:
+    typedef std::pair<double, uint64_t> OfferOrder;
+    typedef std::shared_ptr<LedgerEntry const> OfferPtr;
+
+  private:
+    // selling, buying
+    typedef std::pair<Asset, Asset> AssetPair;
+    struct AssetPairCmp
+    {
+        bool operator()(AssetPair const& a, AssetPair const& b) const;
+    };
+    typedef std::map<OfferOrder, OfferPtr> Book;
+    struct LoadedBook
+    {
+        Book mOffers;
+        // value of mUses when the book was last walked
+        mutable uint64_t mLastUse{0};
+    };
+
+    struct OfferLocation
+    {
+        AssetPair mPair;
+        OfferOrder mOrder;
+    };
+
+    // The pairs an offer changed since the last checkpoint was in; if it was
+    // changed while its pair was not known, every pair.
+    struct Change
+    {
+        std::vector<AssetPair> mPairs;
+        bool mAnyPair{false};
+
+        void add(AssetPair const& pair);
+    };
+
+    size_t const mMaxOffers;
+    std::map<AssetPair, LoadedBook, AssetPairCmp> mBooks;
+    mutable uint64_t mUses{0};
+
+    // Location of every offer in a loaded book, and of every offer changed
+    // since the last checkpoint.
+    std::unordered_map<uint64_t, OfferLocation> mLocations;
+    std::unordered_map<uint64_t, Change> mChanged;
+
+    // removes the offer at `loc` from its book, and records that the offer
+    // was in that pair
+    void moveOut(uint64_t offerID, OfferLocation const& loc);
+    void dropBook(AssetPair const& pair);
+    // drops the least recently walked books other than `pair` until
+    // `offers` more offers fit
+    void makeRoom(AssetPair const& pair, size_t offers);
+
+  public:
+    explicit OrderBook(size_t maxOffers);
+
+    static OfferOrder getOrder(OfferEntry const& offer);
+
+    bool isLoaded(Asset const& selling, Asset const& buying) const;
+
+    // Precondition: !isLoaded(selling, buying). `offers` must be all the
+    // offers selling `selling` for `buying`.
+    void load(Asset const& selling, Asset const& buying,
+              std::vector<LedgerEntry> const& offers);
+
+    // Precondition: isLoaded(selling, buying). Returns the first offer
+    // selling `selling` for `buying` that comes after `after` (or the first
+    // offer at all, if null), or null if there is none.
+    OfferPtr next(Asset const& selling, Asset const& buying,
+                  OfferOrder const* after) const;
+
+    // Record that an offer was stored (inserted if `isNew`), or deleted.
+    void upsert(LedgerEntry const& offer, bool isNew);
+    void erase(OfferEntry const& offer);
+    void erase(uint64_t offerID);
+
+    // Drop the books of every pair `offerID` was in since the last
+    // checkpoint, or every book if those are not known.
+    void invalidate(uint64_t offerID);
+
+    // Forget the changes recorded so far, once they can no longer be rolled
+    // back.
+    void checkpoint();
+
+    void clear();
+};
+}
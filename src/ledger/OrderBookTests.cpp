@@ -0,0 +1,215 @@
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/asio.h"
+#include "LedgerTestUtils.h"
+#include "database/Database.h"
+#include "ledger/LedgerDelta.h"
+#include "ledger/OfferFrame.h"
+#include "ledger/OrderBook.h"
+#include "lib/catch.hpp"
+#include "main/Application.h"
+#include "test/TestUtils.h"
+#include "test/TxTests.h"
+#include "test/test.h"
+#include "util/Timer.h"
+
+using namespace stellar;
+using namespace stellar::txtest;
+
+namespace
+{
+LedgerEntry
+makeOffer(Asset const& selling, Asset const& buying, uint64_t offerID,
+          int32_t n, int32_t d)
+{
+    LedgerEntry le;
+    le.data.type(OFFER);
+    auto& o = le.data.offer();
+    o = LedgerTestUtils::generateValidOfferEntry();
+    o.selling = selling;
+    o.buying = buying;
+    o.offerID = offerID;
+    o.price.n = n;
+    o.price.d = d;
+    return le;
+}
+}
+
+TEST_CASE("order book", "[ledger][orderbook]")
+{
+    Asset native;
+    native.type(ASSET_TYPE_NATIVE);
+    Asset usd = makeAsset(getAccount("issuer"), "USD");
+
+    OrderBook book(100);
+    REQUIRE(!book.isLoaded(usd, native));
+    book.load(usd, native, {makeOffer(usd, native, 3, 1, 2),
+                            makeOffer(usd, native, 1, 1, 1),
+                            makeOffer(usd, native, 2, 1, 2)});
+    REQUIRE(book.isLoaded(usd, native));
+    REQUIRE(!book.isLoaded(native, usd));
+
+    auto ids = [&]() {
+        std::vector<uint64_t> res;
+        OrderBook::OfferOrder after;
+        for (auto o = book.next(usd, native, nullptr); o;
+             o = book.next(usd, native, &after))
+        {
+            res.emplace_back(o->data.offer().offerID);
+            after = OrderBook::getOrder(o->data.offer());
+        }
+        return res;
+    };
+
+    SECTION("sorted by price then offer id")
+    {
+        REQUIRE(ids() == std::vector<uint64_t>{2, 3, 1});
+    }
+
+    SECTION("follows changes")
+    {
+        book.upsert(makeOffer(usd, native, 4, 1, 4), true);
+        book.upsert(makeOffer(usd, native, 2, 2, 1), false);
+        book.erase(3);
+        // another pair's offers are not indexed until it's loaded
+        book.upsert(makeOffer(native, usd, 5, 1, 1), true);
+        REQUIRE(ids() == std::vector<uint64_t>{4, 1, 2});
+    }
+
+    SECTION("invalidating a changed offer drops its book")
+    {
+        book.upsert(makeOffer(usd, native, 4, 1, 4), true);
+        book.invalidate(4);
+        REQUIRE(!book.isLoaded(usd, native));
+    }
+
+    SECTION("invalidating an offer that changed pair drops both books")
+    {
+        book.load(native, usd, {});
+        book.upsert(makeOffer(native, usd, 2, 1, 1), false);
+        REQUIRE(ids() == std::vector<uint64_t>{3, 1});
+        book.invalidate(2);
+        REQUIRE(!book.isLoaded(usd, native));
+        REQUIRE(!book.isLoaded(native, usd));
+    }
+
+    SECTION("invalidating an unknown offer drops every book")
+    {
+        book.erase(5);
+        book.invalidate(5);
+        REQUIRE(!book.isLoaded(usd, native));
+    }
+
+    SECTION("invalidating an update of an offer of an unknown pair drops "
+            "every book")
+    {
+        book.upsert(makeOffer(native, usd, 5, 1, 1), false);
+        book.invalidate(5);
+        REQUIRE(!book.isLoaded(usd, native));
+    }
+}
+
+TEST_CASE("order book size bound", "[ledger][orderbook]")
+{
+    Asset native;
+    native.type(ASSET_TYPE_NATIVE);
+    Asset usd = makeAsset(getAccount("issuer"), "USD");
+    Asset eur = makeAsset(getAccount("issuer"), "EUR");
+
+    OrderBook book(4);
+    book.load(usd, native, {makeOffer(usd, native, 1, 1, 1),
+                            makeOffer(usd, native, 2, 1, 1),
+                            makeOffer(usd, native, 3, 1, 1)});
+    book.load(native, usd, {makeOffer(native, usd, 4, 1, 1)});
+    REQUIRE(book.next(usd, native, nullptr));
+
+    SECTION("least recently walked book dropped to make room")
+    {
+        book.load(eur, native, {makeOffer(eur, native, 5, 1, 1)});
+        REQUIRE(book.isLoaded(usd, native));
+        REQUIRE(!book.isLoaded(native, usd));
+        REQUIRE(book.isLoaded(eur, native));
+    }
+
+    SECTION("book larger than the bound loaded alone")
+    {
+        std::vector<LedgerEntry> offers;
+        for (uint64_t id = 5; id < 10; id++)
+        {
+            offers.emplace_back(makeOffer(eur, native, id, 1, 1));
+        }
+        book.load(eur, native, offers);
+        REQUIRE(!book.isLoaded(usd, native));
+        REQUIRE(!book.isLoaded(native, usd));
+        REQUIRE(book.isLoaded(eur, native));
+    }
+}
+
+TEST_CASE("order book rollback", "[ledger][orderbook]")
+{
+    VirtualClock clock;
+    Application::pointer app = createTestApplication(clock, getTestConfig());
+    app->start();
+    Database& db = app->getDatabase();
+
+    Asset native;
+    native.type(ASSET_TYPE_NATIVE);
+    Asset usd = makeAsset(getAccount("issuer"), "USD");
+
+    LedgerHeader lh;
+    LedgerDelta outer(lh, db, false);
+    for (uint64_t id = 1; id <= 3; id++)
+    {
+        OfferFrame offer(makeOffer(usd, native, id, 1, int32_t(id)));
+        offer.storeAdd(outer, db);
+    }
+
+    // the best offer has the lowest price
+    auto best = OfferFrame::loadBestOffer(usd, native, db);
+    REQUIRE(best->getOfferID() == 3);
+    REQUIRE(OfferFrame::loadBestOffer(usd, native, db, best.get())
+                ->getOfferID() == 2);
+
+    {
+        soci::transaction tx(db.getSession());
+        LedgerDelta inner(outer);
+        best->storeDelete(inner, db);
+        OfferFrame cheaper(makeOffer(usd, native, 4, 1, 10));
+        cheaper.storeAdd(inner, db);
+        REQUIRE(OfferFrame::loadBestOffer(usd, native, db)->getOfferID() ==
+                4);
+        inner.rollback();
+        tx.rollback();
+    }
+
+    best = OfferFrame::loadBestOffer(usd, native, db);
+    REQUIRE(best->getOfferID() == 3);
+    REQUIRE(OfferFrame::loadBestOffer(usd, native, db, best.get())
+                ->getOfferID() == 2);
+
+    SECTION("of an update changing the offer's pair")
+    {
+        {
+            soci::transaction tx(db.getSession());
+            LedgerDelta inner(outer);
+            auto offer = OfferFrame::loadBestOffer(usd, native, db, best.get());
+            REQUIRE(offer->getOfferID() == 2);
+            offer->getOffer().selling = native;
+            offer->getOffer().buying = usd;
+            offer->storeChange(inner, db);
+            REQUIRE(OfferFrame::loadBestOffer(usd, native, db, best.get())
+                        ->getOfferID() == 1);
+            REQUIRE(OfferFrame::loadBestOffer(native, usd, db)->getOfferID() ==
+                    2);
+            inner.rollback();
+            tx.rollback();
+        }
+
+        // the old pair's book has the offer back, the new one doesn't
+        REQUIRE(OfferFrame::loadBestOffer(usd, native, db, best.get())
+                    ->getOfferID() == 2);
+        REQUIRE(!OfferFrame::loadBestOffer(native, usd, db));
+    }
+}
@@ -7,8 +7,10 @@
 #include "crypto/KeyUtils.h"
 #include "crypto/SHA.h"
 #include "crypto/SecretKey.h"
+#include "database/BulkTableWriter.h"
 #include "database/Database.h"
 #include "ledger/LedgerRange.h"
+#include "util/make_unique.h"
 #include "util/types.h"
 
 using namespace std;
@@ -142,9 +144,9 @@ TrustFrame::getMaxAmountReceive() const
 bool
 TrustFrame::exists(Database& db, LedgerKey const& key)
 {
-    if (cachedEntryExists(key, db) && getCachedEntry(key, db) != nullptr)
+    if (cachedEntryExists(key, db))
     {
-        return true;
+        return getCachedEntry(key, db) != nullptr;
     }
 
     std::string actIDStrKey, issuerStrKey, assetCode;
@@ -161,6 +163,10 @@ TrustFrame::exists(Database& db, LedgerKey const& key)
     st.exchange(into(exists));
     st.define_and_bind();
     st.execute(true);
+    if (exists == 0)
+    {
+        putCachedEntry(key, nullptr, db);
+    }
     return exists != 0;
 }
 
@@ -350,15 +356,16 @@ TrustFrame::loadTrustLine(AccountID const& accountID, Asset const& asset,
     if (cachedEntryExists(key, db))
     {
         auto p = getCachedEntry(key, db);
-        if (p)
+        if (!p)
         {
-            pointer ret = std::make_shared<TrustFrame>(*p);
-            if (delta)
-            {
-                delta->recordEntry(*ret);
-            }
-            return ret;
+            return nullptr;
         }
+        pointer ret = std::make_shared<TrustFrame>(*p);
+        if (delta)
+        {
+            delta->recordEntry(*ret);
+        }
+        return ret;
     }
 
     std::string accStr, issuerStr, assetStr;
@@ -485,6 +492,48 @@ TrustFrame::loadLines(AccountID const& accountID,
     });
 }
 
+void
+TrustFrame::prefetchTrustLines(std::vector<LedgerKey> const& keys,
+                               Database& db)
+{
+    std::set<LedgerKey, LedgerEntryIdCmp> missing;
+    std::vector<AccountID> accountIDs;
+    for (auto const& k : keys)
+    {
+        auto const& tl = k.trustLine();
+        // issuers' trust lines are never stored, see loadTrustLine
+        if (tl.asset.type() != ASSET_TYPE_NATIVE &&
+            !(tl.accountID == getIssuer(tl.asset)))
+        {
+            missing.emplace(k);
+            accountIDs.emplace_back(tl.accountID);
+        }
+    }
+    if (missing.empty())
+    {
+        return;
+    }
+
+    // Loads all the trust lines of the accounts involved, and keeps the ones
+    // asked for.
+    auto query = std::string(trustLineColumnSelector);
+    query += " WHERE accountid IN (" + accountIDList(accountIDs) + ")";
+    auto prep = db.getUncachedStatement(query);
+
+    auto timer = db.getSelectTimer("trust-prefetch");
+    loadLines(prep, [&missing, &db](LedgerEntry const& trust) {
+        auto key = LedgerEntryKey(trust);
+        if (missing.erase(key) != 0)
+        {
+            putCachedEntry(key, make_shared<LedgerEntry const>(trust), db);
+        }
+    });
+    for (auto const& k : missing)
+    {
+        putCachedEntry(k, nullptr, db);
+    }
+}
+
 std::unordered_map<AccountID, std::vector<TrustFrame::pointer>>
 TrustFrame::loadAllLines(Database& db)
 {
@@ -502,6 +551,41 @@ TrustFrame::loadAllLines(Database& db)
     return retLines;
 }
 
+std::unique_ptr<BulkTableWriter>
+TrustFrame::makeBulkWriter(Database& db)
+{
+    return make_unique<BulkTableWriter>(
+        db, "trustlines",
+        std::vector<std::string>{"accountid", "assettype", "issuer",
+                                 "assetcode", "tlimit", "balance", "flags",
+                                 "lastmodified"},
+        std::vector<std::string>{"accountid", "issuer", "assetcode"},
+        std::vector<std::string>{"accountid", "issuer", "assetcode"});
+}
+
+void
+TrustFrame::bulkUpsert(BulkTableWriter& lines, LedgerEntry const& entry)
+{
+    auto const& tl = entry.data.trustLine();
+    std::string actIDStrKey, issuerStrKey, assetCode;
+    getKeyFields(LedgerEntryKey(entry), actIDStrKey, issuerStrKey, assetCode);
+    lines.upsert({BulkValue::text(actIDStrKey),
+                  BulkValue::integer(tl.asset.type()),
+                  BulkValue::text(issuerStrKey), BulkValue::text(assetCode),
+                  BulkValue::integer(tl.limit), BulkValue::integer(tl.balance),
+                  BulkValue::integer(tl.flags),
+                  BulkValue::integer(entry.lastModifiedLedgerSeq)});
+}
+
+void
+TrustFrame::bulkErase(BulkTableWriter& lines, LedgerKey const& key)
+{
+    std::string actIDStrKey, issuerStrKey, assetCode;
+    getKeyFields(key, actIDStrKey, issuerStrKey, assetCode);
+    lines.erase({BulkValue::text(actIDStrKey), BulkValue::text(issuerStrKey),
+                 BulkValue::text(assetCode)});
+}
+
 void
 TrustFrame::dropAll(Database& db)
 {
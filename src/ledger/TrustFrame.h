@@ -21,6 +21,7 @@ class prepare_temp_type;
 namespace stellar
 {
 
+class BulkTableWriter;
 class LedgerRange;
 class TrustSetTx;
 class StatementContext;
@@ -80,6 +81,11 @@ class TrustFrame : public EntryFrame
     loadTrustLineIssuer(AccountID const& accountID, Asset const& asset,
                         Database& db, LedgerDelta& delta);
 
+    // loads the requested entries into the entry cache, see
+    // EntryFrame::prefetch
+    static void prefetchTrustLines(std::vector<LedgerKey> const& keys,
+                                   Database& db);
+
     // note: only returns trust lines stored in the database
     static void loadLines(AccountID const& accountID,
                           std::vector<TrustFrame::pointer>& retLines,
@@ -109,6 +115,11 @@ class TrustFrame : public EntryFrame
         return mTrustLine;
     }
 
+    // bulk-loading helpers, used when applying buckets
+    static std::unique_ptr<BulkTableWriter> makeBulkWriter(Database& db);
+    static void bulkUpsert(BulkTableWriter& lines, LedgerEntry const& entry);
+    static void bulkErase(BulkTableWriter& lines, LedgerKey const& key);
+
     static void dropAll(Database& db);
 
   private:
@@ -54,6 +54,8 @@ Config::Config() : NODE_SEED(SecretKey::random())
 
     LOG_FILE_PATH = "stellar-core.%datetime{%Y.%M.%d-%H:%m:%s}.log";
     BUCKET_DIR_PATH = "buckets";
+    BUCKETLIST_IN_MEMORY_LEVELS = 0;
+    PARALLEL_BUCKET_APPLY = false;
 
     TESTING_UPGRADE_DESIRED_FEE = LedgerManager::GENESIS_LEDGER_BASE_FEE;
     TESTING_UPGRADE_RESERVE = LedgerManager::GENESIS_LEDGER_BASE_RESERVE;
@@ -72,6 +74,9 @@ Config::Config() : NODE_SEED(SecretKey::random())
     PREFERRED_PEERS_ONLY = false;
 
     MINIMUM_IDLE_PERCENT = 0;
+    TRANSACTION_QUEUE_MAX_BYTES = 64 * 1024 * 1024;
+    SIGNATURE_CACHE_SIZE = PubKeyUtils::DEFAULT_VERIFY_SIG_CACHE_SIZE;
+    ORDER_BOOK_MAX_OFFERS = 100000;
 
     MAX_CONCURRENT_SUBPROCESSES = 16;
     NODE_IS_VALIDATOR = false;
@@ -324,6 +329,14 @@ Config::load(std::string const& filename)
             {
                 BUCKET_DIR_PATH = readString(item);
             }
+            else if (item.first == "BUCKETLIST_IN_MEMORY_LEVELS")
+            {
+                BUCKETLIST_IN_MEMORY_LEVELS = readInt<uint32_t>(item, 0, 4);
+            }
+            else if (item.first == "PARALLEL_BUCKET_APPLY")
+            {
+                PARALLEL_BUCKET_APPLY = readBool(item);
+            }
             else if (item.first == "NODE_NAMES")
             {
                 auto names = readStringArray(item);
@@ -393,6 +406,18 @@ Config::load(std::string const& filename)
             {
                 COMMANDS = readStringArray(item);
             }
+            else if (item.first == "TRANSACTION_QUEUE_MAX_BYTES")
+            {
+                TRANSACTION_QUEUE_MAX_BYTES = readInt<size_t>(item, 1);
+            }
+            else if (item.first == "SIGNATURE_CACHE_SIZE")
+            {
+                SIGNATURE_CACHE_SIZE = readInt<size_t>(item, 1);
+            }
+            else if (item.first == "ORDER_BOOK_MAX_OFFERS")
+            {
+                ORDER_BOOK_MAX_OFFERS = readInt<size_t>(item, 1);
+            }
             else if (item.first == "MAX_CONCURRENT_SUBPROCESSES")
             {
                 MAX_CONCURRENT_SUBPROCESSES = readInt<size_t>(item, 1);
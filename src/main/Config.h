@@ -136,6 +136,10 @@ class Config : public std::enable_shared_from_this<Config>
     std::string VERSION_STR;
     std::string LOG_FILE_PATH;
     std::string BUCKET_DIR_PATH;
+    // number of lowest BucketList levels kept in memory rather than in files
+    uint32_t BUCKETLIST_IN_MEMORY_LEVELS;
+    // whether to apply buckets over several pooled connections at once
+    bool PARALLEL_BUCKET_APPLY;
     uint32_t TESTING_UPGRADE_DESIRED_FEE; // in stroops
     uint32_t TESTING_UPGRADE_RESERVE;     // in stroops
     uint32_t TESTING_UPGRADE_MAX_TX_PER_LEDGER;
@@ -171,6 +175,17 @@ class Config : public std::enable_shared_from_this<Config>
     // totally insensitive to overloading.
     uint32_t MINIMUM_IDLE_PERCENT;
 
+    // bytes of transaction envelopes kept pending before evicting those
+    // paying the lowest fees
+    size_t TRANSACTION_QUEUE_MAX_BYTES;
+
+    // number of signature verification outcomes remembered; the cache is
+    // process-wide, so the largest value any Application asks for wins
+    size_t SIGNATURE_CACHE_SIZE;
+
+    // number of offers kept loaded in the in-memory order book
+    size_t ORDER_BOOK_MAX_OFFERS;
+
     // process-management config
     size_t MAX_CONCURRENT_SUBPROCESSES;
 
@@ -54,10 +54,12 @@ class Floodgate
     Floodgate(Application& app);
     // Floodgate will be cleared after every ledger close
     void clearBelow(uint32_t currentLedger);
+    // `msgID` is the hash of the XDR of `msg`
     // returns true if this is a new record
-    bool addRecord(StellarMessage const& msg, Peer::pointer fromPeer);
+    bool addRecord(StellarMessage const& msg, Hash const& msgID,
+                   Peer::pointer fromPeer);
 
-    void broadcast(StellarMessage const& msg, bool force);
+    void broadcast(StellarMessage const& msg, Hash const& msgID, bool force);
 
     // returns the list of peers that sent us the item with hash `h`
     std::set<Peer::pointer> getPeersKnows(Hash const& h);
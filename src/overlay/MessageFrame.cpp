@@ -0,0 +1,84 @@
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/asio.h"
+#include "overlay/MessageFrame.h"
+#include "crypto/SHA.h"
+#include "xdrpp/marshal.h"
+#include <cassert>
+#include <cstring>
+
+namespace stellar
+{
+
+static void
+putUint32(uint8_t* out, uint32_t v)
+{
+    out[0] = static_cast<uint8_t>(v >> 24);
+    out[1] = static_cast<uint8_t>(v >> 16);
+    out[2] = static_cast<uint8_t>(v >> 8);
+    out[3] = static_cast<uint8_t>(v);
+}
+
+MessageFrame::BodyPtr
+MessageFrame::encode(StellarMessage const& msg)
+{
+    return std::make_shared<xdr::opaque_vec<> const>(xdr::xdr_to_opaque(msg));
+}
+
+MessageFrame::MessageFrame(BodyPtr body) : mBody(body)
+{
+    setHeader(0);
+    mMac.mac.fill(0);
+}
+
+MessageFrame::MessageFrame(BodyPtr body, uint64 sequence,
+                           HmacSha256Key const& macKey)
+    : mBody(body)
+{
+    setHeader(sequence);
+    // the MAC covers the encoded sequence number and message
+    auto hmac = HmacSha256::create(macKey);
+    hmac->add(ByteSlice(mHeader.data() + 8, 8));
+    hmac->add(*mBody);
+    mMac = hmac->finish();
+}
+
+void
+MessageFrame::setHeader(uint64 sequence)
+{
+    size_t length = size() - 4;
+    assert(length < 0x80000000);
+    putUint32(mHeader.data(), static_cast<uint32_t>(length) | 0x80000000);
+    putUint32(mHeader.data() + 4, 0);
+    putUint32(mHeader.data() + 8, static_cast<uint32_t>(sequence >> 32));
+    putUint32(mHeader.data() + 12, static_cast<uint32_t>(sequence));
+}
+
+std::array<asio::const_buffer, 3>
+MessageFrame::buffers() const
+{
+    return {{asio::buffer(mHeader), asio::buffer(mBody->data(), mBody->size()),
+             asio::buffer(mMac.mac.data(), mMac.mac.size())}};
+}
+
+size_t
+MessageFrame::size() const
+{
+    return HEADER_SIZE + mBody->size() + mMac.mac.size();
+}
+
+xdr::msg_ptr
+MessageFrame::toMsg() const
+{
+    auto msg = xdr::message_t::alloc(size() - 4);
+    auto out = msg->raw_data();
+    memcpy(out, mHeader.data(), mHeader.size());
+    out += mHeader.size();
+    memcpy(out, mBody->data(), mBody->size());
+    out += mBody->size();
+    memcpy(out, mMac.mac.data(), mMac.mac.size());
+    return msg;
+}
+}
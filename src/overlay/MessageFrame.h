@@ -0,0 +1,53 @@
+#pragma once
+
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/asio.h"
+#include "overlay/StellarXDR.h"
+#include "xdrpp/message.h"
+#include <array>
+#include <memory>
+
+namespace stellar
+{
+
+/**
+ * An AuthenticatedMessage laid out to be written without encoding its
+ * StellarMessage again: the record mark, union discriminant and sequence
+ * number, then the StellarMessage, encoded once and shared by every peer it is
+ * sent to, then the MAC of the sequence number and message.
+ *
+ * The bytes written are the same as those of xdr::xdr_to_msg on the
+ * equivalent AuthenticatedMessage.
+ */
+class MessageFrame
+{
+  public:
+    typedef std::shared_ptr<xdr::opaque_vec<> const> BodyPtr;
+
+    static BodyPtr encode(StellarMessage const& msg);
+
+    // without sequence number or MAC, as HELLO and ERROR_MSG are sent
+    explicit MessageFrame(BodyPtr body);
+    MessageFrame(BodyPtr body, uint64 sequence, HmacSha256Key const& macKey);
+
+    // the frame, record mark included; it must outlive the write using them
+    std::array<asio::const_buffer, 3> buffers() const;
+    size_t size() const;
+
+    // a copy of the frame in a single buffer
+    xdr::msg_ptr toMsg() const;
+
+  private:
+    // record mark, union discriminant and sequence number
+    static size_t const HEADER_SIZE = 16;
+
+    std::array<uint8_t, HEADER_SIZE> mHeader;
+    BodyPtr mBody;
+    HmacSha256Mac mMac;
+
+    void setHeader(uint64 sequence);
+};
+}
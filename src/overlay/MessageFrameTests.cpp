@@ -0,0 +1,67 @@
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/asio.h"
+#include "overlay/MessageFrame.h"
+#include "crypto/Random.h"
+#include "crypto/SHA.h"
+#include "lib/catch.hpp"
+#include "xdrpp/marshal.h"
+
+using namespace stellar;
+
+static std::vector<uint8_t>
+frameBytes(MessageFrame const& frame)
+{
+    std::vector<uint8_t> bytes;
+    for (auto const& buf : frame.buffers())
+    {
+        auto data = asio::buffer_cast<uint8_t const*>(buf);
+        bytes.insert(bytes.end(), data, data + asio::buffer_size(buf));
+    }
+    return bytes;
+}
+
+static std::vector<uint8_t>
+msgBytes(xdr::msg_ptr const& msg)
+{
+    auto data = reinterpret_cast<uint8_t const*>(msg->raw_data());
+    return std::vector<uint8_t>(data, data + msg->raw_size());
+}
+
+TEST_CASE("message frames", "[overlay][messageframe]")
+{
+    StellarMessage msg;
+    msg.type(GET_TX_SET);
+    msg.txSetHash() = sha256("TX_SET");
+    auto body = MessageFrame::encode(msg);
+
+    AuthenticatedMessage amsg;
+    amsg.v0().message = msg;
+
+    SECTION("without MAC")
+    {
+        MessageFrame frame(body);
+        auto expected = msgBytes(xdr::xdr_to_msg(amsg));
+        REQUIRE(frame.size() == expected.size());
+        REQUIRE(frameBytes(frame) == expected);
+        REQUIRE(msgBytes(frame.toMsg()) == expected);
+    }
+
+    SECTION("with MAC")
+    {
+        HmacSha256Key key;
+        auto bytes = randomBytes(key.key.size());
+        std::copy(bytes.begin(), bytes.end(), key.key.begin());
+        uint64 sequence = 0x0102030405060708;
+
+        amsg.v0().sequence = sequence;
+        amsg.v0().mac = hmacSha256(key, xdr::xdr_to_opaque(sequence, msg));
+        MessageFrame frame(body, sequence, key);
+        auto expected = msgBytes(xdr::xdr_to_msg(amsg));
+        REQUIRE(frame.size() == expected.size());
+        REQUIRE(frameBytes(frame) == expected);
+        REQUIRE(msgBytes(frame.toMsg()) == expected);
+    }
+}
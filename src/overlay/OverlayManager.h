@@ -75,6 +75,13 @@ class OverlayManager
     virtual void recvFloodedMsg(StellarMessage const& msg,
                                 Peer::pointer peer) = 0;
 
+    // As above, for a message whose ID, the hash of its XDR, is known: saves
+    // serializing the message to hash it.
+    virtual void broadcastMessage(StellarMessage const& msg, Hash const& msgID,
+                                  bool force = false) = 0;
+    virtual void recvFloodedMsg(StellarMessage const& msg, Hash const& msgID,
+                                Peer::pointer peer) = 0;
+
     // Return a list of random peers from the set of authenticated peers.
     virtual std::vector<Peer::pointer> getRandomAuthenticatedPeers() = 0;
 
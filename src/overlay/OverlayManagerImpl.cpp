@@ -4,6 +4,7 @@
 
 #include "overlay/OverlayManagerImpl.h"
 #include "crypto/KeyUtils.h"
+#include "crypto/SHA.h"
 #include "crypto/SecretKey.h"
 #include "database/Database.h"
 #include "main/Application.h"
@@ -12,6 +13,7 @@
 #include "overlay/TCPPeer.h"
 #include "util/Logging.h"
 #include "util/make_unique.h"
+#include "xdrpp/marshal.h"
 
 #include "medida/counter.h"
 #include "medida/meter.h"
@@ -479,16 +481,30 @@ OverlayManagerImpl::getRandomAuthenticatedPeers()
 void
 OverlayManagerImpl::recvFloodedMsg(StellarMessage const& msg,
                                    Peer::pointer peer)
+{
+    recvFloodedMsg(msg, sha256(xdr::xdr_to_opaque(msg)), peer);
+}
+
+void
+OverlayManagerImpl::recvFloodedMsg(StellarMessage const& msg, Hash const& msgID,
+                                   Peer::pointer peer)
 {
     mMessagesReceived.Mark();
-    mFloodGate.addRecord(msg, peer);
+    mFloodGate.addRecord(msg, msgID, peer);
 }
 
 void
 OverlayManagerImpl::broadcastMessage(StellarMessage const& msg, bool force)
+{
+    broadcastMessage(msg, sha256(xdr::xdr_to_opaque(msg)), force);
+}
+
+void
+OverlayManagerImpl::broadcastMessage(StellarMessage const& msg,
+                                     Hash const& msgID, bool force)
 {
     mMessagesBroadcast.Mark();
-    mFloodGate.broadcast(msg, force);
+    mFloodGate.broadcast(msg, msgID, force);
 }
 
 void
@@ -73,6 +73,10 @@ class OverlayManagerImpl : public OverlayManager
     void recvFloodedMsg(StellarMessage const& msg, Peer::pointer peer) override;
     void broadcastMessage(StellarMessage const& msg,
                           bool force = false) override;
+    void broadcastMessage(StellarMessage const& msg, Hash const& msgID,
+                          bool force = false) override;
+    void recvFloodedMsg(StellarMessage const& msg, Hash const& msgID,
+                        Peer::pointer peer) override;
     void connectTo(std::string const& addr) override;
     virtual void connectTo(PeerRecord& pr) override;
 
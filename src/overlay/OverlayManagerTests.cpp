@@ -48,7 +48,7 @@ class PeerStub : public Peer
         return "127.0.0.1";
     }
     virtual void
-    sendMessage(xdr::msg_ptr&& xdrBytes) override
+    sendMessage(MessageFrame&& frame) override
     {
         sent++;
     }
@@ -454,6 +454,12 @@ msgSummary(StellarMessage const& msg)
 
 void
 Peer::sendMessage(StellarMessage const& msg)
+{
+    sendMessage(msg, MessageFrame::encode(msg));
+}
+
+void
+Peer::sendMessage(StellarMessage const& msg, MessageFrame::BodyPtr body)
 {
     if (Logging::logTrace("Overlay"))
         CLOG(TRACE, "Overlay")
@@ -506,17 +512,15 @@ Peer::sendMessage(StellarMessage const& msg)
         break;
     };
 
-    AuthenticatedMessage amsg;
-    amsg.v0().message = msg;
     if (msg.type() != HELLO && msg.type() != ERROR_MSG)
     {
-        amsg.v0().sequence = mSendMacSeq;
-        amsg.v0().mac =
-            hmacSha256(mSendMacKey, xdr::xdr_to_opaque(mSendMacSeq, msg));
+        this->sendMessage(MessageFrame(body, mSendMacSeq, mSendMacKey));
         ++mSendMacSeq;
     }
-    xdr::msg_ptr xdrBytes(xdr::xdr_to_msg(amsg));
-    this->sendMessage(std::move(xdrBytes));
+    else
+    {
+        this->sendMessage(MessageFrame(body));
+    }
 }
 
 void
@@ -534,7 +538,7 @@ Peer::recvMessage(xdr::msg_ptr const& msg)
     {
         AuthenticatedMessage am;
         xdr::xdr_from_msg(msg, am);
-        recvMessage(am);
+        recvMessage(am, msg);
     }
     catch (xdr::xdr_runtime_error& e)
     {
@@ -564,13 +568,23 @@ Peer::shouldAbort() const
 }
 
 void
-Peer::recvMessage(AuthenticatedMessage const& msg)
+Peer::recvMessage(AuthenticatedMessage const& msg, ByteSlice const& bytes)
 {
     if (shouldAbort())
     {
         return;
     }
 
+    // the XDR of v0 is the version, the sequence number, the message and the
+    // MAC, which is over the sequence number and the message
+    size_t const versionSize = 4;
+    size_t const sequenceSize = 8;
+    size_t const macSize = msg.v0().mac.mac.size();
+    ByteSlice macBytes(bytes.data() + versionSize,
+                       bytes.size() - versionSize - macSize);
+    ByteSlice messageBytes(bytes.data() + versionSize + sequenceSize,
+                           bytes.size() - versionSize - sequenceSize - macSize);
+
     if (mState >= GOT_HELLO && msg.v0().message.type() != ERROR_MSG)
     {
         if (msg.v0().sequence != mRecvMacSeq)
@@ -582,9 +596,7 @@ Peer::recvMessage(AuthenticatedMessage const& msg)
             return;
         }
 
-        if (!hmacSha256Verify(
-                msg.v0().mac, mRecvMacKey,
-                xdr::xdr_to_opaque(msg.v0().sequence, msg.v0().message)))
+        if (!hmacSha256Verify(msg.v0().mac, mRecvMacKey, macBytes))
         {
             CLOG(ERROR, "Overlay") << "Message-auth check failed";
             mDropInRecvMessageMacMeter.Mark();
@@ -594,11 +606,11 @@ Peer::recvMessage(AuthenticatedMessage const& msg)
         }
         ++mRecvMacSeq;
     }
-    recvMessage(msg.v0().message);
+    recvMessage(msg.v0().message, messageBytes);
 }
 
 void
-Peer::recvMessage(StellarMessage const& stellarMsg)
+Peer::recvMessage(StellarMessage const& stellarMsg, ByteSlice const& bytes)
 {
     if (shouldAbort())
     {
@@ -687,7 +699,7 @@ Peer::recvMessage(StellarMessage const& stellarMsg)
     case TRANSACTION:
     {
         auto t = mRecvTransactionTimer.TimeScope();
-        recvTransaction(stellarMsg);
+        recvTransaction(stellarMsg, bytes);
     }
     break;
 
@@ -708,7 +720,7 @@ Peer::recvMessage(StellarMessage const& stellarMsg)
     case SCP_MESSAGE:
     {
         auto t = mRecvSCPMessageTimer.TimeScope();
-        recvSCPMessage(stellarMsg);
+        recvSCPMessage(stellarMsg, bytes);
     }
     break;
 
@@ -754,10 +766,13 @@ Peer::recvTxSet(StellarMessage const& msg)
 }
 
 void
-Peer::recvTransaction(StellarMessage const& msg)
+Peer::recvTransaction(StellarMessage const& msg, ByteSlice const& bytes)
 {
+    // the envelope follows the message type
+    size_t const typeSize = 4;
     TransactionFramePtr transaction = TransactionFrame::makeTransactionFromWire(
-        mApp.getNetworkID(), msg.transaction());
+        mApp.getNetworkID(), msg.transaction(),
+        ByteSlice(bytes.data() + typeSize, bytes.size() - typeSize));
     if (transaction)
     {
         // add it to our current set
@@ -768,12 +783,14 @@ Peer::recvTransaction(StellarMessage const& msg)
             recvRes == Herder::TX_STATUS_DUPLICATE)
         {
             // record that this peer sent us this transaction
-            mApp.getOverlayManager().recvFloodedMsg(msg, shared_from_this());
+            Hash msgID = sha256(bytes);
+            mApp.getOverlayManager().recvFloodedMsg(msg, msgID,
+                                                    shared_from_this());
 
             if (recvRes == Herder::TX_STATUS_PENDING)
             {
                 // if it's a new transaction, broadcast it
-                mApp.getOverlayManager().broadcastMessage(msg);
+                mApp.getOverlayManager().broadcastMessage(msg, msgID);
             }
         }
     }
@@ -805,7 +822,7 @@ Peer::recvSCPQuorumSet(StellarMessage const& msg)
 }
 
 void
-Peer::recvSCPMessage(StellarMessage const& msg)
+Peer::recvSCPMessage(StellarMessage const& msg, ByteSlice const& bytes)
 {
     SCPEnvelope const& envelope = msg.envelope();
     if (Logging::logTrace("Overlay"))
@@ -813,7 +830,8 @@ Peer::recvSCPMessage(StellarMessage const& msg)
             << "recvSCPMessage node: "
             << mApp.getConfig().toShortString(msg.envelope().statement.nodeID);
 
-    mApp.getOverlayManager().recvFloodedMsg(msg, shared_from_this());
+    mApp.getOverlayManager().recvFloodedMsg(msg, sha256(bytes),
+                                            shared_from_this());
 
     auto type = msg.envelope().statement.pledges.type();
     auto t = (type == SCP_ST_PREPARE
@@ -824,7 +842,7 @@ Peer::recvSCPMessage(StellarMessage const& msg)
                                 ? mRecvSCPExternalizeTimer.TimeScope()
                                 : (mRecvSCPNominateTimer.TimeScope()))));
 
-    mApp.getHerder().recvSCPEnvelope(envelope);
+    mApp.getHerder().recvUnverifiedSCPEnvelope(envelope);
 }
 
 void
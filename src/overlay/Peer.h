@@ -5,7 +5,9 @@
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
 #include "util/asio.h"
+#include "crypto/ByteSlice.h"
 #include "database/Database.h"
+#include "overlay/MessageFrame.h"
 #include "overlay/StellarXDR.h"
 #include "util/NonCopyable.h"
 #include "util/Timer.h"
@@ -136,8 +138,9 @@ class Peer : public std::enable_shared_from_this<Peer>,
     medida::Meter& mDropInRecvErrorMeter;
 
     bool shouldAbort() const;
-    void recvMessage(StellarMessage const& msg);
-    void recvMessage(AuthenticatedMessage const& msg);
+    // `bytes` is the XDR `msg` was decoded from
+    void recvMessage(StellarMessage const& msg, ByteSlice const& bytes);
+    void recvMessage(AuthenticatedMessage const& msg, ByteSlice const& bytes);
     void recvMessage(xdr::msg_ptr const& xdrBytes);
 
     virtual void recvError(StellarMessage const& msg);
@@ -151,10 +154,10 @@ class Peer : public std::enable_shared_from_this<Peer>,
 
     void recvGetTxSet(StellarMessage const& msg);
     void recvTxSet(StellarMessage const& msg);
-    void recvTransaction(StellarMessage const& msg);
+    void recvTransaction(StellarMessage const& msg, ByteSlice const& bytes);
     void recvGetSCPQuorumSet(StellarMessage const& msg);
     void recvSCPQuorumSet(StellarMessage const& msg);
-    void recvSCPMessage(StellarMessage const& msg);
+    void recvSCPMessage(StellarMessage const& msg, ByteSlice const& bytes);
     void recvGetSCPState(StellarMessage const& msg);
 
     void sendHello();
@@ -163,14 +166,12 @@ class Peer : public std::enable_shared_from_this<Peer>,
     void sendDontHave(MessageType type, uint256 const& itemID);
     void sendPeers();
 
-    // NB: This is a move-argument because the write-buffer has to travel
-    // with the write-request through the async IO system, and we might have
-    // several queued at once. We have carefully arranged this to not copy
-    // data more than the once necessary into this buffer, but it can't be
-    // put in a reused/non-owned buffer without having to buffer/queue
-    // messages somewhere else. The async write request will point _into_
-    // this owned buffer. This is really the best we can do.
-    virtual void sendMessage(xdr::msg_ptr&& xdrBytes) = 0;
+    // NB: This is a move-argument because the frame has to travel with the
+    // write-request through the async IO system, and we might have several
+    // queued at once. The async write request will point _into_ this owned
+    // frame, and into the message bytes it shares with the frames of the
+    // other peers the message is sent to.
+    virtual void sendMessage(MessageFrame&& frame) = 0;
     virtual void
     connected()
     {
@@ -200,6 +201,9 @@ class Peer : public std::enable_shared_from_this<Peer>,
     void sendGetScpState(uint32 ledgerSeq);
 
     void sendMessage(StellarMessage const& msg);
+    // sends msg, already encoded as body, as when broadcasting it to several
+    // peers
+    void sendMessage(StellarMessage const& msg, MessageFrame::BodyPtr body);
 
     PeerRole
     getRole() const
@@ -121,14 +121,14 @@ TCPPeer::getIP()
 }
 
 void
-TCPPeer::sendMessage(xdr::msg_ptr&& xdrBytes)
+TCPPeer::sendMessage(MessageFrame&& frame)
 {
     if (Logging::logTrace("Overlay"))
         CLOG(TRACE, "Overlay") << "TCPPeer:sendMessage to " << toString();
     assertThreadIsMain();
 
-    // places the buffer to write into the write queue
-    auto buf = std::make_shared<xdr::msg_ptr>(std::move(xdrBytes));
+    // places the frame to write into the write queue
+    auto buf = std::make_shared<MessageFrame const>(std::move(frame));
 
     auto self = static_pointer_cast<TCPPeer>(shared_from_this());
 
@@ -175,7 +175,7 @@ TCPPeer::messageSender()
     auto buf = mWriteQueue.front();
 
     asio::async_write(*(mSocket.get()),
-                      asio::buffer((*buf)->raw_data(), (*buf)->raw_size()),
+                      buf->buffers(),
                       [self](asio::error_code const& ec, std::size_t length) {
                           self->writeHandler(ec, length);
                           self->mWriteQueue.pop(); // done with front element
@@ -355,7 +355,7 @@ TCPPeer::recvMessage()
                        mIncomingBody.data() + mIncomingBody.size());
         AuthenticatedMessage am;
         xdr::xdr_argpack_archive(g, am);
-        Peer::recvMessage(am);
+        Peer::recvMessage(am, mIncomingBody);
     }
     catch (xdr::xdr_runtime_error& e)
     {
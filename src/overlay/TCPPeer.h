@@ -31,11 +31,11 @@ class TCPPeer : public Peer
     std::vector<uint8_t> mIncomingHeader;
     std::vector<uint8_t> mIncomingBody;
 
-    std::queue<std::shared_ptr<xdr::msg_ptr>> mWriteQueue;
+    std::queue<std::shared_ptr<MessageFrame const>> mWriteQueue;
     bool mWriting{false};
 
     void recvMessage();
-    void sendMessage(xdr::msg_ptr&& xdrBytes) override;
+    void sendMessage(MessageFrame&& frame) override;
 
     void messageSender();
 
@@ -26,6 +26,9 @@ using namespace std::placeholders;
 // max number of transitions that can occur from processing one message
 static const int MAX_ADVANCE_SLOT_RECURSION = 50;
 
+// max number of vote tallies kept, they are rebuilt as needed past that
+static const size_t MAX_VOTE_TALLIES = 1024;
+
 BallotProtocol::BallotProtocol(Slot& slot)
     : mSlot(slot)
     , mHeardFromQuorum(true)
@@ -140,10 +143,12 @@ BallotProtocol::recordEnvelope(SCPEnvelope const& env)
     auto oldp = mLatestEnvelopes.find(st.nodeID);
     if (oldp == mLatestEnvelopes.end())
     {
+        updateVoteTallies(nullptr, st);
         mLatestEnvelopes.insert(std::make_pair(st.nodeID, env));
     }
     else
     {
+        updateVoteTallies(&oldp->second.statement, st);
         oldp->second = env;
     }
     mSlot.recordStatement(env.statement);
@@ -818,40 +823,7 @@ BallotProtocol::attemptPreparedAccept(SCPStatement const& hint)
             // otherwise, there is a chance it increases p'
         }
 
-        bool accepted = federatedAccept(
-            // checks if any node is voting for this ballot
-            [&ballot, this](SCPStatement const& st) {
-                bool res;
-
-                switch (st.pledges.type())
-                {
-                case SCP_ST_PREPARE:
-                {
-                    auto const& p = st.pledges.prepare();
-                    res = areBallotsLessAndCompatible(ballot, p.ballot);
-                }
-                break;
-                case SCP_ST_CONFIRM:
-                {
-                    auto const& c = st.pledges.confirm();
-                    res = areBallotsCompatible(ballot, c.ballot);
-                }
-                break;
-                case SCP_ST_EXTERNALIZE:
-                {
-                    auto const& e = st.pledges.externalize();
-                    res = areBallotsCompatible(ballot, e.commit);
-                }
-                break;
-                default:
-                    res = false;
-                    dbgAbort();
-                }
-
-                return res;
-            },
-            std::bind(&BallotProtocol::hasPreparedBallot, ballot, _1));
-        if (accepted)
+        if (federatedAcceptPrepare(ballot))
         {
             return setPreparedAccept(ballot);
         }
@@ -925,9 +897,7 @@ BallotProtocol::attemptPreparedConfirmed(SCPStatement const& hint)
             break;
         }
 
-        bool ratified = federatedRatify(
-            std::bind(&BallotProtocol::hasPreparedBallot, ballot, _1));
-        if (ratified)
+        if (federatedRatifyPrepare(ballot))
         {
             newH = ballot;
             newHfound = true;
@@ -956,9 +926,7 @@ BallotProtocol::attemptPreparedConfirmed(SCPStatement const& hint)
                 {
                     break;
                 }
-                bool ratified = federatedRatify(
-                    std::bind(&BallotProtocol::hasPreparedBallot, ballot, _1));
-                if (ratified)
+                if (federatedRatifyPrepare(ballot))
                 {
                     newC = ballot;
                 }
@@ -1183,48 +1151,7 @@ BallotProtocol::attemptAcceptCommit(SCPStatement const& hint)
     }
 
     auto pred = [&ballot, this](Interval const& cur) -> bool {
-        return federatedAccept(
-            [&](SCPStatement const& st) -> bool {
-                bool res = false;
-                auto const& pl = st.pledges;
-                switch (pl.type())
-                {
-                case SCP_ST_PREPARE:
-                {
-                    auto const& p = pl.prepare();
-                    if (areBallotsCompatible(ballot, p.ballot))
-                    {
-                        if (p.nC != 0)
-                        {
-                            res = p.nC <= cur.first && cur.second <= p.nH;
-                        }
-                    }
-                }
-                break;
-                case SCP_ST_CONFIRM:
-                {
-                    auto const& c = pl.confirm();
-                    if (areBallotsCompatible(ballot, c.ballot))
-                    {
-                        res = c.nCommit <= cur.first;
-                    }
-                }
-                break;
-                case SCP_ST_EXTERNALIZE:
-                {
-                    auto const& e = pl.externalize();
-                    if (areBallotsCompatible(ballot, e.commit))
-                    {
-                        res = e.commit.counter <= cur.first;
-                    }
-                }
-                break;
-                default:
-                    dbgAbort();
-                }
-                return res;
-            },
-            std::bind(&BallotProtocol::commitPredicate, ballot, cur, _1));
+        return federatedAcceptCommit(ballot, cur);
     };
 
     // build the boundaries to scan
@@ -1347,9 +1274,8 @@ BallotProtocol::attemptBump()
                 break;
             }
 
-            bool vBlocking = LocalNode::isVBlocking(
-                getLocalNode()->getQuorumSet(), mLatestEnvelopes,
-                [&](SCPStatement const& st) {
+            bool vBlocking = mSlot.isVBlocking(
+                mLatestEnvelopes, [&](SCPStatement const& st) {
                     bool res;
                     auto const& pl = st.pledges;
                     if (pl.type() == SCP_ST_PREPARE)
@@ -1441,8 +1367,7 @@ BallotProtocol::attemptConfirmCommit(SCPStatement const& hint)
     Interval candidate;
 
     auto pred = [&ballot, this](Interval const& cur) -> bool {
-        return federatedRatify(
-            std::bind(&BallotProtocol::commitPredicate, ballot, cur, _1));
+        return federatedRatifyCommit(ballot, cur);
     };
 
     findExtendedInterval(candidate, boundaries, pred);
@@ -1482,6 +1407,83 @@ BallotProtocol::setConfirmCommit(SCPBallot const& c, SCPBallot const& h)
     return true;
 }
 
+bool
+BallotProtocol::hasVotedPrepare(SCPBallot const& ballot, SCPStatement const& st)
+{
+    bool res;
+
+    switch (st.pledges.type())
+    {
+    case SCP_ST_PREPARE:
+    {
+        auto const& p = st.pledges.prepare();
+        res = areBallotsLessAndCompatible(ballot, p.ballot);
+    }
+    break;
+    case SCP_ST_CONFIRM:
+    {
+        auto const& c = st.pledges.confirm();
+        res = areBallotsCompatible(ballot, c.ballot);
+    }
+    break;
+    case SCP_ST_EXTERNALIZE:
+    {
+        auto const& e = st.pledges.externalize();
+        res = areBallotsCompatible(ballot, e.commit);
+    }
+    break;
+    default:
+        res = false;
+        dbgAbort();
+    }
+
+    return res;
+}
+
+bool
+BallotProtocol::hasVotedCommit(SCPBallot const& ballot, Interval const& check,
+                               SCPStatement const& st)
+{
+    bool res = false;
+    auto const& pl = st.pledges;
+    switch (pl.type())
+    {
+    case SCP_ST_PREPARE:
+    {
+        auto const& p = pl.prepare();
+        if (areBallotsCompatible(ballot, p.ballot))
+        {
+            if (p.nC != 0)
+            {
+                res = p.nC <= check.first && check.second <= p.nH;
+            }
+        }
+    }
+    break;
+    case SCP_ST_CONFIRM:
+    {
+        auto const& c = pl.confirm();
+        if (areBallotsCompatible(ballot, c.ballot))
+        {
+            res = c.nCommit <= check.first;
+        }
+    }
+    break;
+    case SCP_ST_EXTERNALIZE:
+    {
+        auto const& e = pl.externalize();
+        if (areBallotsCompatible(ballot, e.commit))
+        {
+            res = e.commit.counter <= check.first;
+        }
+    }
+    break;
+    default:
+        dbgAbort();
+    }
+    return res;
+}
+
 bool
 BallotProtocol::hasPreparedBallot(SCPBallot const& ballot,
                                   SCPStatement const& st)
@@ -1806,10 +1808,8 @@ BallotProtocol::advanceSlot(SCPStatement const& hint)
     // when a single message causes several
     if (!mHeardFromQuorum && mCurrentBallot)
     {
-        if (LocalNode::isQuorum(
-                getLocalNode()->getQuorumSet(), mLatestEnvelopes,
-                std::bind(&Slot::getQuorumSetFromStatement, &mSlot, _1),
-                [&](SCPStatement const& st) {
+        if (mSlot.isQuorum(
+                mLatestEnvelopes, [&](SCPStatement const& st) {
                     bool res;
                     if (st.pledges.type() == SCP_ST_PREPARE)
                     {
@@ -2079,15 +2079,191 @@ BallotProtocol::getLocalNode()
 }
 
 bool
-BallotProtocol::federatedAccept(StatementPredicate voted,
-                                StatementPredicate accepted)
+BallotProtocol::VoteKeyLess::operator()(VoteKey const& a,
+                                        VoteKey const& b) const
+{
+    if (a.mCommit != b.mCommit)
+    {
+        return !a.mCommit;
+    }
+    int c = compareBallots(a.mBallot, b.mBallot);
+    if (c != 0)
+    {
+        return c < 0;
+    }
+    return a.mInterval < b.mInterval;
+}
+
+// whether the quorum set of the node is the same in both statements
+static bool
+isSameQuorumSet(SCPStatement const& oldst, SCPStatement const& st)
+{
+    bool oldExternalize = oldst.pledges.type() == SCP_ST_EXTERNALIZE;
+    bool externalize = st.pledges.type() == SCP_ST_EXTERNALIZE;
+    if (oldExternalize || externalize)
+    {
+        // the singleton {{nodeID}}
+        return oldExternalize && externalize;
+    }
+    return BallotProtocol::getCompanionQuorumSetHashFromStatement(oldst) ==
+           BallotProtocol::getCompanionQuorumSetHashFromStatement(st);
+}
+
+// returns true if the membership of nodeID changed
+static bool
+updateMembership(std::set<NodeID>& nodes, NodeID const& nodeID, bool member)
+{
+    if (member)
+    {
+        return nodes.insert(nodeID).second;
+    }
+    return nodes.erase(nodeID) != 0;
+}
+
+void
+BallotProtocol::updateVoteTallies(SCPStatement const* oldst,
+                                  SCPStatement const& st)
+{
+    bool sameQSet = oldst && isSameQuorumSet(*oldst, st);
+    for (auto& t : mVoteTallies)
+    {
+        auto& tally = t.second;
+        bool changed =
+            updateMembership(tally.mVotedNodes, st.nodeID, tally.mVoted(st));
+        changed = updateMembership(tally.mAcceptedNodes, st.nodeID,
+                                   tally.mAccepted(st)) ||
+                  changed;
+        bool member = tally.mVotedNodes.count(st.nodeID) != 0 ||
+                      tally.mAcceptedNodes.count(st.nodeID) != 0;
+        if (changed || (member && !sameQSet))
+        {
+            tally.mAccept = SCP::TB_MAYBE;
+            tally.mRatify = SCP::TB_MAYBE;
+        }
+    }
+}
+
+BallotProtocol::VoteTally&
+BallotProtocol::getVoteTally(VoteKey const& key, StatementPredicate voted,
+                             StatementPredicate accepted)
+{
+    auto const& qSetHash = getLocalNode()->getQuorumSetHash();
+    if (!(qSetHash == mVoteTalliesQSetHash))
+    {
+        for (auto& t : mVoteTallies)
+        {
+            t.second.mAccept = SCP::TB_MAYBE;
+            t.second.mRatify = SCP::TB_MAYBE;
+        }
+        mVoteTalliesQSetHash = qSetHash;
+    }
+
+    auto it = mVoteTallies.find(key);
+    if (it != mVoteTallies.end())
+    {
+        return it->second;
+    }
+
+    if (mVoteTallies.size() >= MAX_VOTE_TALLIES)
+    {
+        mVoteTallies.clear();
+    }
+    auto& tally = mVoteTallies[key];
+    tally.mVoted = voted;
+    tally.mAccepted = accepted;
+    for (auto const& e : mLatestEnvelopes)
+    {
+        auto const& st = e.second.statement;
+        if (voted(st))
+        {
+            tally.mVotedNodes.insert(e.first);
+        }
+        if (accepted(st))
+        {
+            tally.mAcceptedNodes.insert(e.first);
+        }
+    }
+    return tally;
+}
+
+bool
+BallotProtocol::federatedAccept(VoteTally& tally)
+{
+    if (tally.mAccept == SCP::TB_MAYBE)
+    {
+        auto const& voted = tally.mVotedNodes;
+        auto const& accepted = tally.mAcceptedNodes;
+        bool res = mSlot.federatedAccept(
+            [&](SCPStatement const& st) {
+                return voted.find(st.nodeID) != voted.end();
+            },
+            [&](SCPStatement const& st) {
+                return accepted.find(st.nodeID) != accepted.end();
+            },
+            mLatestEnvelopes);
+        tally.mAccept = res ? SCP::TB_TRUE : SCP::TB_FALSE;
+    }
+    return tally.mAccept == SCP::TB_TRUE;
+}
+
+bool
+BallotProtocol::federatedRatify(VoteTally& tally)
+{
+    if (tally.mRatify == SCP::TB_MAYBE)
+    {
+        auto const& accepted = tally.mAcceptedNodes;
+        bool res = mSlot.federatedRatify(
+            [&](SCPStatement const& st) {
+                return accepted.find(st.nodeID) != accepted.end();
+            },
+            mLatestEnvelopes);
+        tally.mRatify = res ? SCP::TB_TRUE : SCP::TB_FALSE;
+    }
+    return tally.mRatify == SCP::TB_TRUE;
+}
+
+BallotProtocol::VoteTally&
+BallotProtocol::getPrepareTally(SCPBallot const& ballot)
+{
+    return getVoteTally(
+        VoteKey{false, ballot, Interval(0, 0)},
+        std::bind(&BallotProtocol::hasVotedPrepare, ballot, _1),
+        std::bind(&BallotProtocol::hasPreparedBallot, ballot, _1));
+}
+
+BallotProtocol::VoteTally&
+BallotProtocol::getCommitTally(SCPBallot const& ballot, Interval const& check)
+{
+    // only the value of the ballot matters
+    return getVoteTally(
+        VoteKey{true, SCPBallot(0, ballot.value), check},
+        std::bind(&BallotProtocol::hasVotedCommit, ballot, check, _1),
+        std::bind(&BallotProtocol::commitPredicate, ballot, check, _1));
+}
+
+bool
+BallotProtocol::federatedAcceptPrepare(SCPBallot const& ballot)
+{
+    return federatedAccept(getPrepareTally(ballot));
+}
+
+bool
+BallotProtocol::federatedRatifyPrepare(SCPBallot const& ballot)
+{
+    return federatedRatify(getPrepareTally(ballot));
+}
+
+bool
+BallotProtocol::federatedAcceptCommit(SCPBallot const& ballot,
+                                      Interval const& check)
 {
-    return mSlot.federatedAccept(voted, accepted, mLatestEnvelopes);
+    return federatedAccept(getCommitTally(ballot, check));
 }
 
 bool
-BallotProtocol::federatedRatify(StatementPredicate voted)
+BallotProtocol::federatedRatifyCommit(SCPBallot const& ballot,
+                                      Interval const& check)
 {
-    return mSlot.federatedRatify(voted, mLatestEnvelopes);
+    return federatedRatify(getCommitTally(ballot, check));
 }
 }
@@ -7,6 +7,7 @@
 #include "lib/json/json-forwards.h"
 #include "scp/SCP.h"
 #include <functional>
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
@@ -183,6 +184,14 @@ class BallotProtocol
     // ** helper predicates that evaluate if a statement satisfies
     // a certain property
 
+    // does st vote for preparing ballot
+    static bool hasVotedPrepare(SCPBallot const& ballot,
+                                SCPStatement const& st);
+
+    // does st vote for committing the ballot in the range 'check'
+    static bool hasVotedCommit(SCPBallot const& ballot, Interval const& check,
+                               SCPStatement const& st);
+
     // is ballot prepared by st
     static bool hasPreparedBallot(SCPBallot const& ballot,
                                   SCPStatement const& st);
@@ -256,8 +265,53 @@ class BallotProtocol
 
     std::shared_ptr<LocalNode> getLocalNode();
 
-    bool federatedAccept(StatementPredicate voted, StatementPredicate accepted);
-    bool federatedRatify(StatementPredicate voted);
+    // Federated voting on "prepare(ballot)" or on "commit" of a ballot's
+    // value over an interval of counters: the nodes whose latest statement
+    // votes for it and those whose latest statement accepted it, kept up to
+    // date by recordEnvelope, so that an envelope only re-evaluates the
+    // predicates of its own statement. The outcomes of federatedAccept and
+    // federatedRatify are kept until an envelope changes either set or the
+    // quorum set of one of their nodes (the quorum sets of recorded
+    // statements are known, see isStatementSane).
+    struct VoteTally
+    {
+        StatementPredicate mVoted;
+        StatementPredicate mAccepted;
+        std::set<NodeID> mVotedNodes;
+        std::set<NodeID> mAcceptedNodes;
+        SCP::TriBool mAccept{SCP::TB_MAYBE};
+        SCP::TriBool mRatify{SCP::TB_MAYBE};
+    };
+    // prepare (ballot) or commit (value only, counter 0, and interval)
+    struct VoteKey
+    {
+        bool mCommit;
+        SCPBallot mBallot;
+        Interval mInterval;
+    };
+    struct VoteKeyLess
+    {
+        bool operator()(VoteKey const& a, VoteKey const& b) const;
+    };
+    std::map<VoteKey, VoteTally, VoteKeyLess> mVoteTallies;
+    // the local quorum set the outcomes were evaluated with
+    Hash mVoteTalliesQSetHash;
+
+    // updates the tallies for st, replacing oldst (if any) from the same node
+    void updateVoteTallies(SCPStatement const* oldst, SCPStatement const& st);
+    VoteTally& getVoteTally(VoteKey const& key, StatementPredicate voted,
+                            StatementPredicate accepted);
+    VoteTally& getPrepareTally(SCPBallot const& ballot);
+    VoteTally& getCommitTally(SCPBallot const& ballot, Interval const& check);
+
+    bool federatedAccept(VoteTally& tally);
+    // ratifies what the tally's nodes accepted
+    bool federatedRatify(VoteTally& tally);
+
+    bool federatedAcceptPrepare(SCPBallot const& ballot);
+    bool federatedRatifyPrepare(SCPBallot const& ballot);
+    bool federatedAcceptCommit(SCPBallot const& ballot, Interval const& check);
+    bool federatedRatifyCommit(SCPBallot const& ballot, Interval const& check);
 
     void startBallotProtocolTimer();
 };
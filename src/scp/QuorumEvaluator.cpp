@@ -0,0 +1,238 @@
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "scp/QuorumEvaluator.h"
+
+namespace stellar
+{
+
+// Only reached when quorum sets keep changing, or by a flood of quorum sets
+// naming made-up nodes.
+static size_t const kMaxCompiledQuorumSets = 4096;
+static size_t const kMaxNodeNumbers = 1 << 16;
+
+void
+QuorumEvaluator::NodeSet::insert(size_t node)
+{
+    auto word = node / 64;
+    if (word >= mWords.size())
+    {
+        mWords.resize(word + 1, 0);
+    }
+    mWords[word] |= uint64_t(1) << (node % 64);
+}
+
+void
+QuorumEvaluator::NodeSet::erase(size_t node)
+{
+    auto word = node / 64;
+    if (word < mWords.size())
+    {
+        mWords[word] &= ~(uint64_t(1) << (node % 64));
+    }
+}
+
+size_t
+QuorumEvaluator::getNodeNumber(NodeID const& node)
+{
+    auto it = mNodeNumbers.find(node);
+    if (it != mNodeNumbers.end())
+    {
+        return it->second;
+    }
+    auto number = mNodeNumbers.size();
+    mNodeNumbers.emplace(node, number);
+    return number;
+}
+
+void
+QuorumEvaluator::maybeReset()
+{
+    if (mCompiled.size() + mSingletons.size() > kMaxCompiledQuorumSets ||
+        mNodeNumbers.size() > kMaxNodeNumbers)
+    {
+        mCompiled.clear();
+        mSingletons.clear();
+        mNodeNumbers.clear();
+    }
+}
+
+QuorumEvaluator::CompiledQuorumSet
+QuorumEvaluator::compileInternal(SCPQuorumSet const& qSet)
+{
+    CompiledQuorumSet res;
+    res.mThreshold = qSet.threshold;
+    res.mValidators.reserve(qSet.validators.size());
+    for (auto const& validator : qSet.validators)
+    {
+        res.mValidators.push_back(getNodeNumber(validator));
+    }
+    res.mInnerSets.reserve(qSet.innerSets.size());
+    for (auto const& inner : qSet.innerSets)
+    {
+        res.mInnerSets.emplace_back(compileInternal(inner));
+    }
+    return res;
+}
+
+QuorumEvaluator::CompiledQuorumSetPtr
+QuorumEvaluator::compile(Hash const& hash, SCPQuorumSet const& qSet)
+{
+    auto& res = mCompiled[hash];
+    if (!res)
+    {
+        res = std::make_shared<CompiledQuorumSet>(compileInternal(qSet));
+    }
+    return res;
+}
+
+QuorumEvaluator::CompiledQuorumSetPtr
+QuorumEvaluator::compileSingleton(NodeID const& node)
+{
+    auto& res = mSingletons[node];
+    if (!res)
+    {
+        auto qSet = std::make_shared<CompiledQuorumSet>();
+        qSet->mThreshold = 1;
+        qSet->mValidators.push_back(getNodeNumber(node));
+        res = qSet;
+    }
+    return res;
+}
+
+// same arithmetic as LocalNode::isQuorumSliceInternal
+bool
+QuorumEvaluator::isQuorumSlice(CompiledQuorumSet const& qSet,
+                               NodeSet const& nodeSet)
+{
+    if (qSet.mThreshold == 0)
+    {
+        return false;
+    }
+
+    uint32 thresholdLeft = qSet.mThreshold;
+    for (auto validator : qSet.mValidators)
+    {
+        if (nodeSet.contains(validator) && --thresholdLeft == 0)
+        {
+            return true;
+        }
+    }
+    for (auto const& inner : qSet.mInnerSets)
+    {
+        if (isQuorumSlice(inner, nodeSet) && --thresholdLeft == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// same arithmetic as LocalNode::isVBlockingInternal
+bool
+QuorumEvaluator::isVBlocking(CompiledQuorumSet const& qSet,
+                             NodeSet const& nodeSet)
+{
+    // There is no v-blocking set for {\empty}
+    if (qSet.mThreshold == 0)
+    {
+        return false;
+    }
+
+    int leftTillBlock =
+        (int)((1 + qSet.mValidators.size() + qSet.mInnerSets.size()) -
+              qSet.mThreshold);
+    for (auto validator : qSet.mValidators)
+    {
+        if (nodeSet.contains(validator) && --leftTillBlock <= 0)
+        {
+            return true;
+        }
+    }
+    for (auto const& inner : qSet.mInnerSets)
+    {
+        if (isVBlocking(inner, nodeSet) && --leftTillBlock <= 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+QuorumEvaluator::NodeSet
+QuorumEvaluator::filterNodes(
+    std::map<NodeID, SCPEnvelope> const& map,
+    std::function<bool(SCPStatement const&)> const& filter)
+{
+    NodeSet res;
+    for (auto const& it : map)
+    {
+        if (filter(it.second.statement))
+        {
+            res.insert(getNodeNumber(it.first));
+        }
+    }
+    return res;
+}
+
+bool
+QuorumEvaluator::isVBlocking(
+    Hash const& hash, SCPQuorumSet const& qSet,
+    std::map<NodeID, SCPEnvelope> const& map,
+    std::function<bool(SCPStatement const&)> const& filter)
+{
+    maybeReset();
+    auto compiled = compile(hash, qSet);
+    return isVBlocking(*compiled, filterNodes(map, filter));
+}
+
+bool
+QuorumEvaluator::isQuorum(
+    Hash const& hash, SCPQuorumSet const& qSet,
+    std::map<NodeID, SCPEnvelope> const& map,
+    std::function<CompiledQuorumSetPtr(SCPStatement const&)> const& qfun,
+    std::function<bool(SCPStatement const&)> const& filter)
+{
+    maybeReset();
+    auto compiled = compile(hash, qSet);
+
+    // nodes without a known quorum set can never be part of the quorum
+    std::vector<std::pair<size_t, CompiledQuorumSetPtr>> nodes;
+    NodeSet pNodes;
+    for (auto const& it : map)
+    {
+        auto const& st = it.second.statement;
+        if (!filter(st))
+        {
+            continue;
+        }
+        auto nodeQSet = qfun(st);
+        if (nodeQSet)
+        {
+            auto node = getNodeNumber(it.first);
+            nodes.emplace_back(node, nodeQSet);
+            pNodes.insert(node);
+        }
+    }
+
+    // removing nodes one at a time reaches the same fixed point as
+    // LocalNode::isQuorum, as slices only lose members along the way
+    bool changed;
+    do
+    {
+        changed = false;
+        for (auto& node : nodes)
+        {
+            if (node.second && !isQuorumSlice(*node.second, pNodes))
+            {
+                pNodes.erase(node.first);
+                node.second.reset();
+                changed = true;
+            }
+        }
+    } while (changed);
+
+    return isQuorumSlice(*compiled, pNodes);
+}
+}
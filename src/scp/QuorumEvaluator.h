@@ -0,0 +1,105 @@
+#pragma once
+
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "crypto/SecretKey.h"
+#include "util/HashOfHash.h"
+#include "util/NonCopyable.h"
+#include "xdr/Stellar-SCP.h"
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace stellar
+{
+
+/**
+ * Answers the same questions as LocalNode::isVBlocking and LocalNode::isQuorum,
+ * on quorum sets compiled once per quorum set hash.
+ *
+ * Every node gets a small number the first time it is seen, and a compiled
+ * quorum set refers to its validators by those numbers. Sets of nodes are then
+ * bitsets, so that checking a validator against them is a bit test instead of
+ * a search through a vector of node IDs, for every validator of every inner
+ * set, every time a statement is received.
+ *
+ * Compiled quorum sets are only valid for the numbering they were compiled
+ * with; everything is forgotten together when the caches grow too large, and
+ * only ever between two evaluations.
+ */
+class QuorumEvaluator : NonMovableOrCopyable
+{
+  public:
+    class NodeSet
+    {
+        std::vector<uint64_t> mWords;
+
+      public:
+        bool
+        contains(size_t node) const
+        {
+            auto word = node / 64;
+            return word < mWords.size() &&
+                   (mWords[word] & (uint64_t(1) << (node % 64))) != 0;
+        }
+
+        void insert(size_t node);
+        void erase(size_t node);
+    };
+
+    struct CompiledQuorumSet
+    {
+        uint32 mThreshold{0};
+        // node numbers, duplicates included, as they count twice in the
+        // original
+        std::vector<size_t> mValidators;
+        std::vector<CompiledQuorumSet> mInnerSets;
+    };
+    typedef std::shared_ptr<CompiledQuorumSet const> CompiledQuorumSetPtr;
+
+  private:
+    std::unordered_map<NodeID, size_t> mNodeNumbers;
+    std::unordered_map<Hash, CompiledQuorumSetPtr> mCompiled;
+    std::unordered_map<NodeID, CompiledQuorumSetPtr> mSingletons;
+
+    CompiledQuorumSet compileInternal(SCPQuorumSet const& qSet);
+
+    // forgets everything if the caches grew too large; only called before
+    // compiling the quorum sets of an evaluation
+    void maybeReset();
+
+    NodeSet
+    filterNodes(std::map<NodeID, SCPEnvelope> const& map,
+                std::function<bool(SCPStatement const&)> const& filter);
+
+  public:
+    size_t getNodeNumber(NodeID const& node);
+
+    // `hash` is the hash of `qSet`, which is only compiled the first time.
+    CompiledQuorumSetPtr compile(Hash const& hash, SCPQuorumSet const& qSet);
+    // the quorum set {{node}}
+    CompiledQuorumSetPtr compileSingleton(NodeID const& node);
+
+    static bool isQuorumSlice(CompiledQuorumSet const& qSet,
+                              NodeSet const& nodeSet);
+    static bool isVBlocking(CompiledQuorumSet const& qSet,
+                            NodeSet const& nodeSet);
+
+    // As LocalNode::isVBlocking and LocalNode::isQuorum, for the quorum set
+    // `qSet` with hash `hash`.
+    bool isVBlocking(Hash const& hash, SCPQuorumSet const& qSet,
+                     std::map<NodeID, SCPEnvelope> const& map,
+                     std::function<bool(SCPStatement const&)> const& filter);
+    bool
+    isQuorum(Hash const& hash, SCPQuorumSet const& qSet,
+             std::map<NodeID, SCPEnvelope> const& map,
+             std::function<CompiledQuorumSetPtr(SCPStatement const&)> const&
+                 qfun,
+             std::function<bool(SCPStatement const&)> const& filter);
+};
+}
@@ -0,0 +1,202 @@
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "scp/QuorumEvaluator.h"
+#include "crypto/SHA.h"
+#include "crypto/SecretKey.h"
+#include "lib/catch.hpp"
+#include "scp/LocalNode.h"
+#include "util/Logging.h"
+#include "util/Math.h"
+#include "xdrpp/marshal.h"
+
+using namespace stellar;
+
+static std::vector<NodeID>
+makeNodes(size_t n)
+{
+    std::vector<NodeID> nodes;
+    for (size_t i = 0; i < n; i++)
+    {
+        auto seed = sha256("NODE_SEED_" + std::to_string(i));
+        nodes.emplace_back(SecretKey::fromSeed(seed).getPublicKey());
+    }
+    return nodes;
+}
+
+// groups of organizations of validators, the top level needing all groups but
+// one, each group all organizations but one and each organization two thirds
+// of its validators
+static SCPQuorumSet
+makeNestedQSet(std::vector<NodeID> const& nodes, size_t groups, size_t orgs)
+{
+    size_t perOrg = nodes.size() / (groups * orgs);
+    SCPQuorumSet top;
+    top.threshold = static_cast<uint32>(groups - 1);
+    auto node = nodes.begin();
+    for (size_t g = 0; g < groups; g++)
+    {
+        SCPQuorumSet group;
+        group.threshold = static_cast<uint32>(orgs - 1);
+        for (size_t o = 0; o < orgs; o++)
+        {
+            SCPQuorumSet org;
+            org.threshold = static_cast<uint32>((2 * perOrg + 2) / 3);
+            for (size_t v = 0; v < perOrg; v++)
+            {
+                org.validators.emplace_back(*node++);
+            }
+            group.innerSets.emplace_back(org);
+        }
+        top.innerSets.emplace_back(group);
+    }
+    return top;
+}
+
+static std::map<NodeID, SCPEnvelope>
+makeEnvelopes(std::vector<NodeID> const& nodes,
+              std::vector<Hash> const& qSetHashes)
+{
+    std::map<NodeID, SCPEnvelope> envs;
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        SCPEnvelope env;
+        env.statement.nodeID = nodes[i];
+        env.statement.pledges.type(SCP_ST_NOMINATE);
+        env.statement.pledges.nominate().quorumSetHash =
+            qSetHashes[i % qSetHashes.size()];
+        envs.emplace(nodes[i], env);
+    }
+    return envs;
+}
+
+TEST_CASE("compiled quorum sets", "[scp][quorum]")
+{
+    auto nodes = makeNodes(60);
+    auto nested = makeNestedQSet(nodes, 3, 4);
+
+    // a duplicate validator, one without an envelope and an inner set
+    auto others = makeNodes(61);
+    SCPQuorumSet flat;
+    flat.threshold = 4;
+    for (auto const& node :
+         {nodes[0], nodes[0], nodes[7], nodes[13], nodes[59], others.back()})
+    {
+        flat.validators.emplace_back(node);
+    }
+    flat.innerSets.emplace_back(makeNestedQSet(nodes, 2, 2));
+
+    SCPQuorumSet empty;
+    empty.threshold = 0;
+    empty.validators.emplace_back(nodes[1]);
+
+    std::map<Hash, SCPQuorumSetPtr> qSets;
+    for (auto const& qSet : {nested, flat, empty})
+    {
+        qSets.emplace(sha256(xdr::xdr_to_opaque(qSet)),
+                      std::make_shared<SCPQuorumSet>(qSet));
+    }
+    // plus a hash nobody knows the quorum set of
+    std::vector<Hash> hashes;
+    for (auto const& qSet : qSets)
+    {
+        hashes.emplace_back(qSet.first);
+    }
+    hashes.emplace_back(sha256("UNKNOWN_QSET"));
+    auto envs = makeEnvelopes(nodes, hashes);
+
+    QuorumEvaluator evaluator;
+    auto qfun = [&](SCPStatement const& st) -> SCPQuorumSetPtr {
+        auto it = qSets.find(st.pledges.nominate().quorumSetHash);
+        return it == qSets.end() ? nullptr : it->second;
+    };
+    auto compiledQfun =
+        [&](SCPStatement const& st) -> QuorumEvaluator::CompiledQuorumSetPtr {
+        auto const& h = st.pledges.nominate().quorumSetHash;
+        auto qSet = qfun(st);
+        return qSet ? evaluator.compile(h, *qSet) : nullptr;
+    };
+
+    for (int i = 0; i < 500; i++)
+    {
+        // from sparse to dense sets of nodes
+        auto density = rand_fraction();
+        std::set<NodeID> chosen;
+        std::vector<NodeID> nodeSet;
+        QuorumEvaluator::NodeSet bits;
+        for (auto const& node : nodes)
+        {
+            if (rand_fraction() < density)
+            {
+                chosen.insert(node);
+                nodeSet.emplace_back(node);
+                bits.insert(evaluator.getNodeNumber(node));
+            }
+        }
+        auto filter = [&](SCPStatement const& st) {
+            return chosen.find(st.nodeID) != chosen.end();
+        };
+
+        for (auto const& qSet : qSets)
+        {
+            auto compiled = evaluator.compile(qSet.first, *qSet.second);
+            REQUIRE(QuorumEvaluator::isQuorumSlice(*compiled, bits) ==
+                    LocalNode::isQuorumSlice(*qSet.second, nodeSet));
+            REQUIRE(QuorumEvaluator::isVBlocking(*compiled, bits) ==
+                    LocalNode::isVBlocking(*qSet.second, nodeSet));
+            REQUIRE(evaluator.isVBlocking(qSet.first, *qSet.second, envs,
+                                          filter) ==
+                    LocalNode::isVBlocking(*qSet.second, envs, filter));
+            REQUIRE(evaluator.isQuorum(qSet.first, *qSet.second, envs,
+                                       compiledQfun, filter) ==
+                    LocalNode::isQuorum(*qSet.second, envs, qfun, filter));
+        }
+    }
+}
+
+TEST_CASE("compiled quorum sets benchmarking", "[scp][quorum][bench][hide]")
+{
+    size_t const n = 10000;
+    auto nodes = makeNodes(120);
+    auto qSet = makeNestedQSet(nodes, 5, 4);
+    auto qSetHash = sha256(xdr::xdr_to_opaque(qSet));
+    auto qSetPtr = std::make_shared<SCPQuorumSet>(qSet);
+    auto envs = makeEnvelopes(nodes, {qSetHash});
+
+    // every node but one per organization, a quorum only found after
+    // evaluating every slice
+    std::set<NodeID> missing;
+    for (size_t i = 0; i < nodes.size(); i += 6)
+    {
+        missing.insert(nodes[i]);
+    }
+    auto filter = [&](SCPStatement const& st) {
+        return missing.find(st.nodeID) == missing.end();
+    };
+
+    LOG(INFO) << "Benchmarking " << n << " quorum and v-blocking checks over "
+              << nodes.size() << " validators";
+    {
+        TIMED_SCOPE(timerBlkObj, "LocalNode");
+        auto qfun = [&](SCPStatement const&) { return qSetPtr; };
+        for (size_t i = 0; i < n; i++)
+        {
+            REQUIRE(LocalNode::isQuorum(qSet, envs, qfun, filter));
+            REQUIRE(LocalNode::isVBlocking(qSet, envs, filter));
+        }
+    }
+
+    {
+        TIMED_SCOPE(timerBlkObj, "QuorumEvaluator");
+        QuorumEvaluator evaluator;
+        auto qfun = [&](SCPStatement const&) {
+            return evaluator.compile(qSetHash, qSet);
+        };
+        for (size_t i = 0; i < n; i++)
+        {
+            REQUIRE(evaluator.isQuorum(qSetHash, qSet, envs, qfun, filter));
+            REQUIRE(evaluator.isVBlocking(qSetHash, qSet, envs, filter));
+        }
+    }
+}
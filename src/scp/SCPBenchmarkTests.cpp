@@ -0,0 +1,410 @@
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "crypto/SHA.h"
+#include "crypto/SecretKey.h"
+#include "lib/catch.hpp"
+#include "scp/SCP.h"
+#include "util/Logging.h"
+#include "util/Math.h"
+#include "util/make_unique.h"
+#include "xdrpp/marshal.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <new>
+#include <string>
+
+// Counting allocations means replacing the global operator new of the whole
+// binary, so it is only done when built with
+// -DSCP_BENCH_COUNT_ALLOCATIONS; the benchmark reports them as n/a
+// otherwise.
+static std::atomic<uint64_t> gAllocations{0};
+
+#ifdef SCP_BENCH_COUNT_ALLOCATIONS
+void*
+operator new(std::size_t size)
+{
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void
+operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+#endif
+
+namespace stellar
+{
+
+using xdr::operator==;
+
+namespace
+{
+
+enum class Topology
+{
+    FLAT,      // everybody trusts everybody
+    TIERED,    // everybody trusts a core tier of a fifth of the nodes
+    ORG_BASED, // organizations of three validators, two of which must agree
+};
+
+enum class ArrivalOrder
+{
+    FIFO,   // in the order envelopes were emitted
+    LIFO,   // latest envelope first
+    RANDOM, // any pending envelope
+};
+
+char const*
+topologyName(Topology t)
+{
+    switch (t)
+    {
+    case Topology::FLAT:
+        return "flat";
+    case Topology::TIERED:
+        return "tiered";
+    default:
+        return "org-based";
+    }
+}
+
+char const*
+orderName(ArrivalOrder o)
+{
+    switch (o)
+    {
+    case ArrivalOrder::FIFO:
+        return "fifo";
+    case ArrivalOrder::LIFO:
+        return "lifo";
+    default:
+        return "random";
+    }
+}
+
+uint32
+twoThirds(size_t n)
+{
+    return static_cast<uint32>(1 + (2 * n) / 3);
+}
+
+class BenchNetwork;
+
+// An SCPDriver that trusts every envelope and value, and hands what it emits
+// to the network.
+class BenchNode : public SCPDriver
+{
+    BenchNetwork& mNetwork;
+
+  public:
+    SCP mSCP;
+    std::map<std::pair<uint64, int>, std::function<void()>> mTimers;
+    std::set<uint64> mExternalized;
+
+    BenchNode(BenchNetwork& network, SecretKey const& key,
+              SCPQuorumSet const& qSet)
+        : mNetwork(network), mSCP(*this, key, true, qSet)
+    {
+    }
+
+    void
+    signEnvelope(SCPEnvelope&) override
+    {
+    }
+
+    bool
+    verifyEnvelope(SCPEnvelope const&) override
+    {
+        return true;
+    }
+
+    SCPQuorumSetPtr getQSet(Hash const& qSetHash) override;
+
+    void emitEnvelope(SCPEnvelope const& envelope) override;
+
+    ValidationLevel
+    validateValue(uint64, Value const&, bool) override
+    {
+        return kFullyValidatedValue;
+    }
+
+    Value
+    combineCandidates(uint64, std::set<Value> const& candidates) override
+    {
+        return *candidates.rbegin();
+    }
+
+    void
+    setupTimer(uint64 slotIndex, int timerID, std::chrono::milliseconds,
+               std::function<void()> cb) override
+    {
+        auto key = std::make_pair(slotIndex, timerID);
+        if (cb)
+        {
+            mTimers[key] = cb;
+        }
+        else
+        {
+            mTimers.erase(key);
+        }
+    }
+
+    void
+    valueExternalized(uint64 slotIndex, Value const&) override
+    {
+        mExternalized.insert(slotIndex);
+    }
+};
+
+struct BenchResult
+{
+    uint64_t mEnvelopes{0};
+    std::chrono::nanoseconds mReceiveTime{0};
+    std::chrono::nanoseconds mExternalizeTime{0};
+    uint64_t mAllocations{0};
+    size_t mTimeouts{0};
+};
+
+// Nodes exchanging envelopes in memory: every envelope emitted is delivered
+// to every other node, in the given order. Timers only fire when no envelope
+// is left to deliver.
+class BenchNetwork
+{
+    ArrivalOrder mOrder;
+    std::deque<std::pair<size_t, SCPEnvelope>> mPending;
+    std::vector<NodeID> mNodeIDs;
+    std::vector<std::unique_ptr<BenchNode>> mNodes;
+
+    SCPQuorumSet
+    makeQSet(Topology topology) const
+    {
+        SCPQuorumSet qSet;
+        switch (topology)
+        {
+        case Topology::FLAT:
+            for (auto const& id : mNodeIDs)
+            {
+                qSet.validators.emplace_back(id);
+            }
+            qSet.threshold = twoThirds(mNodeIDs.size());
+            break;
+        case Topology::TIERED:
+        {
+            size_t core = std::max<size_t>(4, mNodeIDs.size() / 5);
+            for (size_t i = 0; i < core; i++)
+            {
+                qSet.validators.emplace_back(mNodeIDs[i]);
+            }
+            qSet.threshold = twoThirds(core);
+            break;
+        }
+        default:
+        {
+            for (size_t i = 0; i + 3 <= mNodeIDs.size(); i += 3)
+            {
+                SCPQuorumSet org;
+                org.threshold = 2;
+                for (size_t j = i; j < i + 3; j++)
+                {
+                    org.validators.emplace_back(mNodeIDs[j]);
+                }
+                qSet.innerSets.emplace_back(org);
+            }
+            qSet.threshold = twoThirds(qSet.innerSets.size());
+            break;
+        }
+        }
+        return qSet;
+    }
+
+  public:
+    std::map<Hash, SCPQuorumSetPtr> mQuorumSets;
+
+    BenchNetwork(size_t size, Topology topology, ArrivalOrder order)
+        : mOrder(order)
+    {
+        std::vector<SecretKey> keys;
+        for (size_t i = 0; i < size; i++)
+        {
+            keys.emplace_back(SecretKey::fromSeed(
+                sha256("SCP_BENCH_NODE_" + std::to_string(i))));
+            mNodeIDs.emplace_back(keys.back().getPublicKey());
+        }
+        // every node has the same quorum set
+        auto qSet = std::make_shared<SCPQuorumSet>(makeQSet(topology));
+        mQuorumSets[sha256(xdr::xdr_to_opaque(*qSet))] = qSet;
+        for (auto const& key : keys)
+        {
+            mNodes.emplace_back(make_unique<BenchNode>(*this, key, *qSet));
+        }
+    }
+
+    void
+    broadcast(SCPEnvelope const& envelope)
+    {
+        for (size_t i = 0; i < mNodeIDs.size(); i++)
+        {
+            if (!(mNodeIDs[i] == envelope.statement.nodeID))
+            {
+                mPending.emplace_back(i, envelope);
+            }
+        }
+    }
+
+    // nominates the same value on every node and delivers envelopes until
+    // they all externalized it
+    void
+    runSlot(uint64 slotIndex, Value const& value, Value const& prev,
+            BenchResult& res)
+    {
+        using namespace std::chrono;
+        auto start = steady_clock::now();
+        auto allocations = gAllocations.load();
+        for (auto& node : mNodes)
+        {
+            node->mSCP.nominate(slotIndex, value, prev);
+        }
+
+        size_t timeouts = 0;
+        for (;;)
+        {
+            while (!mPending.empty())
+            {
+                std::pair<size_t, SCPEnvelope> next;
+                if (mOrder == ArrivalOrder::LIFO)
+                {
+                    next = std::move(mPending.back());
+                    mPending.pop_back();
+                }
+                else
+                {
+                    if (mOrder == ArrivalOrder::RANDOM)
+                    {
+                        std::swap(mPending.front(),
+                                  mPending[rand_uniform<size_t>(
+                                      0, mPending.size() - 1)]);
+                    }
+                    next = std::move(mPending.front());
+                    mPending.pop_front();
+                }
+
+                auto before = steady_clock::now();
+                mNodes[next.first]->mSCP.receiveEnvelope(next.second);
+                res.mReceiveTime += steady_clock::now() - before;
+                res.mEnvelopes++;
+            }
+
+            bool done = true;
+            for (auto const& node : mNodes)
+            {
+                done = done && node->mExternalized.count(slotIndex) != 0;
+            }
+            if (done)
+            {
+                break;
+            }
+
+            // nothing left in flight: time out
+            REQUIRE(++timeouts < 100);
+            for (auto& node : mNodes)
+            {
+                auto timers = node->mTimers;
+                node->mTimers.clear();
+                for (auto& timer : timers)
+                {
+                    timer.second();
+                }
+            }
+        }
+
+        res.mExternalizeTime += steady_clock::now() - start;
+        res.mAllocations += gAllocations.load() - allocations;
+        res.mTimeouts += timeouts;
+        for (auto& node : mNodes)
+        {
+            node->mSCP.purgeSlots(slotIndex);
+        }
+    }
+};
+
+SCPQuorumSetPtr
+BenchNode::getQSet(Hash const& qSetHash)
+{
+    auto it = mNetwork.mQuorumSets.find(qSetHash);
+    return it == mNetwork.mQuorumSets.end() ? nullptr : it->second;
+}
+
+void
+BenchNode::emitEnvelope(SCPEnvelope const& envelope)
+{
+    mNetwork.broadcast(envelope);
+}
+
+BenchResult
+runBenchmark(size_t size, Topology topology, ArrivalOrder order, uint64 slots)
+{
+    BenchNetwork network(size, topology, order);
+    BenchResult res;
+    Value prev;
+    for (uint64 slot = 1; slot <= slots; slot++)
+    {
+        auto value = xdr::xdr_to_opaque(
+            sha256("SCP_BENCH_VALUE_" + std::to_string(slot)));
+        network.runSlot(slot, value, prev, res);
+        prev = value;
+    }
+    return res;
+}
+}
+
+TEST_CASE("SCP benchmarking", "[scp][bench][hide]")
+{
+    // adjust to taste
+    std::vector<size_t> const sizes = {10, 31, 100};
+    uint64 const slots = 5;
+
+    for (auto size : sizes)
+    {
+        for (auto topology :
+             {Topology::FLAT, Topology::TIERED, Topology::ORG_BASED})
+        {
+            for (auto order : {ArrivalOrder::FIFO, ArrivalOrder::LIFO,
+                               ArrivalOrder::RANDOM})
+            {
+                auto res = runBenchmark(size, topology, order, slots);
+
+                using namespace std::chrono;
+                auto receiveUs = duration_cast<microseconds>(res.mReceiveTime);
+                auto externalizeMs =
+                    duration_cast<milliseconds>(res.mExternalizeTime);
+                std::string allocations = "n/a";
+#ifdef SCP_BENCH_COUNT_ALLOCATIONS
+                allocations = std::to_string(
+                    res.mAllocations / std::max<uint64_t>(1, res.mEnvelopes));
+#endif
+                LOG(INFO) << size << " nodes, " << topologyName(topology)
+                          << ", " << orderName(order) << ": "
+                          << res.mEnvelopes << " envelopes, "
+                          << (res.mEnvelopes * 1000000 /
+                              std::max<int64_t>(1, receiveUs.count()))
+                          << " envelopes/s, "
+                          << externalizeMs.count() / slots
+                          << "ms to externalize, " << res.mTimeouts
+                          << " timeouts, " << allocations
+                          << " allocations per envelope";
+            }
+        }
+    }
+}
+}
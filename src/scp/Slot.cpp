@@ -294,6 +294,24 @@ Slot::getQuorumSetFromStatement(SCPStatement const& st)
     return res;
 }
 
+QuorumEvaluator::CompiledQuorumSetPtr
+Slot::getCompiledQuorumSetFromStatement(SCPStatement const& st)
+{
+    auto& evaluator = mSCP.getQuorumEvaluator();
+    if (st.pledges.type() == SCP_ST_EXTERNALIZE)
+    {
+        return evaluator.compileSingleton(st.nodeID);
+    }
+
+    auto h = getCompanionQuorumSetHashFromStatement(st);
+    auto qSet = getSCPDriver().getQSet(h);
+    if (!qSet)
+    {
+        return nullptr;
+    }
+    return evaluator.compile(h, *qSet);
+}
+
 void
 Slot::dumpInfo(Json::Value& ret)
 {
@@ -339,13 +357,34 @@ Slot::dumpQuorumInfo(Json::Value& ret, NodeID const& id, bool summary)
     mBallotProtocol.dumpQuorumInfo(ret[i], id, summary);
 }
 
+bool
+Slot::isVBlocking(std::map<NodeID, SCPEnvelope> const& envs,
+                  std::function<bool(SCPStatement const&)> const& filter)
+{
+    auto localNode = getLocalNode();
+    return mSCP.getQuorumEvaluator().isVBlocking(
+        localNode->getQuorumSetHash(), localNode->getQuorumSet(), envs,
+        filter);
+}
+
+bool
+Slot::isQuorum(std::map<NodeID, SCPEnvelope> const& envs,
+               std::function<bool(SCPStatement const&)> const& filter)
+{
+    auto localNode = getLocalNode();
+    return mSCP.getQuorumEvaluator().isQuorum(
+        localNode->getQuorumSetHash(), localNode->getQuorumSet(), envs,
+        std::bind(&Slot::getCompiledQuorumSetFromStatement, this, _1),
+        filter);
+}
+
 bool
 Slot::federatedAccept(StatementPredicate voted, StatementPredicate accepted,
                       std::map<NodeID, SCPEnvelope> const& envs)
 {
     // Checks if the nodes that claimed to accept the statement form a
     // v-blocking set
-    if (LocalNode::isVBlocking(getLocalNode()->getQuorumSet(), envs, accepted))
+    if (isVBlocking(envs, accepted))
     {
         return true;
     }
@@ -358,10 +397,7 @@ Slot::federatedAccept(StatementPredicate voted, StatementPredicate accepted,
         return res;
     };
 
-    if (LocalNode::isQuorum(
-            getLocalNode()->getQuorumSet(), envs,
-            std::bind(&Slot::getQuorumSetFromStatement, this, _1),
-            ratifyFilter))
+    if (isQuorum(envs, ratifyFilter))
     {
         return true;
     }
@@ -373,9 +409,7 @@ bool
 Slot::federatedRatify(StatementPredicate voted,
                       std::map<NodeID, SCPEnvelope> const& envs)
 {
-    return LocalNode::isQuorum(
-        getLocalNode()->getQuorumSet(), envs,
-        std::bind(&Slot::getQuorumSetFromStatement, this, _1), voted);
+    return isQuorum(envs, voted);
 }
 
 std::shared_ptr<LocalNode>
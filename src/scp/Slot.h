@@ -150,12 +150,22 @@ class Slot : public std::enable_shared_from_this<Slot>
     // returns the QuorumSet that should be used for a node given the
     // statement (singleton for externalize)
     SCPQuorumSetPtr getQuorumSetFromStatement(SCPStatement const& st);
+    // same, compiled by the SCP instance's QuorumEvaluator
+    QuorumEvaluator::CompiledQuorumSetPtr
+    getCompiledQuorumSetFromStatement(SCPStatement const& st);
 
     // wraps a statement in an envelope (sign it, etc)
     SCPEnvelope createEnvelope(SCPStatement const& statement);
 
     // ** federated agreement helper functions
 
+    // LocalNode::isVBlocking and LocalNode::isQuorum for the local node's
+    // quorum set, evaluated on compiled quorum sets
+    bool isVBlocking(std::map<NodeID, SCPEnvelope> const& envs,
+                     std::function<bool(SCPStatement const&)> const& filter);
+    bool isQuorum(std::map<NodeID, SCPEnvelope> const& envs,
+                  std::function<bool(SCPStatement const&)> const& filter);
+
     // returns true if the statement defined by voted and accepted
     // should be accepted
     bool federatedAccept(StatementPredicate voted, StatementPredicate accepted,
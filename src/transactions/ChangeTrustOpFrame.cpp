@@ -138,6 +138,14 @@ ChangeTrustOpFrame::doApply(Application& app, LedgerDelta& delta,
     }
 }
 
+void
+ChangeTrustOpFrame::insertLedgerKeysToPrefetch(
+    std::set<LedgerKey, LedgerEntryIdCmp>& keys) const
+{
+    OperationFrame::insertLedgerKeysToPrefetch(keys);
+    insertAssetKeysToPrefetch(keys, getSourceID(), mChangeTrust.line);
+}
+
 bool
 ChangeTrustOpFrame::doCheckValid(Application& app)
 {
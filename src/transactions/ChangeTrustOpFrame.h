@@ -25,6 +25,9 @@ class ChangeTrustOpFrame : public OperationFrame
                  LedgerManager& ledgerManager) override;
     bool doCheckValid(Application& app) override;
 
+    void insertLedgerKeysToPrefetch(
+        std::set<LedgerKey, LedgerEntryIdCmp>& keys) const override;
+
     static ChangeTrustResultCode
     getInnerCode(OperationResult const& res)
     {
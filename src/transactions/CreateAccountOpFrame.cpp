@@ -99,6 +99,14 @@ CreateAccountOpFrame::doApply(Application& app, LedgerDelta& delta,
     }
 }
 
+void
+CreateAccountOpFrame::insertLedgerKeysToPrefetch(
+    std::set<LedgerKey, LedgerEntryIdCmp>& keys) const
+{
+    OperationFrame::insertLedgerKeysToPrefetch(keys);
+    keys.emplace(accountKey(mCreateAccount.destination));
+}
+
 bool
 CreateAccountOpFrame::doCheckValid(Application& app)
 {
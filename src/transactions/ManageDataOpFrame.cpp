@@ -97,6 +97,14 @@ ManageDataOpFrame::doApply(Application& app, LedgerDelta& delta,
     return true;
 }
 
+void
+ManageDataOpFrame::insertLedgerKeysToPrefetch(
+    std::set<LedgerKey, LedgerEntryIdCmp>& keys) const
+{
+    OperationFrame::insertLedgerKeysToPrefetch(keys);
+    keys.emplace(dataKey(getSourceID(), mManageData.dataName));
+}
+
 bool
 ManageDataOpFrame::doCheckValid(Application& app)
 {
@@ -27,6 +27,9 @@ class ManageDataOpFrame : public OperationFrame
                  LedgerManager& ledgerManager) override;
     bool doCheckValid(Application& app) override;
 
+    void insertLedgerKeysToPrefetch(
+        std::set<LedgerKey, LedgerEntryIdCmp>& keys) const override;
+
     static ManageDataResultCode
     getInnerCode(OperationResult const& res)
     {
@@ -420,6 +420,15 @@ ManageOfferOpFrame::doApply(Application& app, LedgerDelta& delta,
     return true;
 }
 
+void
+ManageOfferOpFrame::insertLedgerKeysToPrefetch(
+    std::set<LedgerKey, LedgerEntryIdCmp>& keys) const
+{
+    OperationFrame::insertLedgerKeysToPrefetch(keys);
+    insertAssetKeysToPrefetch(keys, getSourceID(), mManageOffer.selling);
+    insertAssetKeysToPrefetch(keys, getSourceID(), mManageOffer.buying);
+}
+
 // makes sure the currencies are different
 bool
 ManageOfferOpFrame::doCheckValid(Application& app)
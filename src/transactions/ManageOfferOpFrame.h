@@ -42,6 +42,9 @@ class ManageOfferOpFrame : public OperationFrame
                  LedgerManager& ledgerManager) override;
     bool doCheckValid(Application& app) override;
 
+    void insertLedgerKeysToPrefetch(
+        std::set<LedgerKey, LedgerEntryIdCmp>& keys) const override;
+
     static ManageOfferResultCode
     getInnerCode(OperationResult const& res)
     {
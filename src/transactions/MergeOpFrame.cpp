@@ -127,6 +127,14 @@ MergeOpFrame::doApply(Application& app, LedgerDelta& delta,
     return true;
 }
 
+void
+MergeOpFrame::insertLedgerKeysToPrefetch(
+    std::set<LedgerKey, LedgerEntryIdCmp>& keys) const
+{
+    OperationFrame::insertLedgerKeysToPrefetch(keys);
+    keys.emplace(accountKey(mOperation.body.destination()));
+}
+
 bool
 MergeOpFrame::doCheckValid(Application& app)
 {
@@ -262,79 +262,69 @@ OfferExchange::convertWithOffers(
 
     Database& db = mLedgerManager.getDatabase();
 
-    size_t offerOffset = 0;
+    // the last offer visited; offers are walked in the order they are
+    // crossed, so the next one is the best offer after it (taken offers
+    // having been deleted from the order book)
+    OfferFrame::pointer wheatOffer;
 
     bool needMore = (maxWheatReceive > 0 && maxSheepSend > 0);
 
     while (needMore)
     {
-        std::vector<OfferFrame::pointer> retList;
-        OfferFrame::loadBestOffers(5, offerOffset, wheat, sheep, retList, db);
-
-        offerOffset += retList.size();
+        wheatOffer =
+            OfferFrame::loadBestOffer(wheat, sheep, db, wheatOffer.get());
+        if (!wheatOffer)
+        {
+            // still stuff to fill but no more offers
+            break;
+        }
 
-        for (auto& wheatOffer : retList)
+        if (filter)
         {
-            if (filter)
+            OfferFilterResult r = filter(*wheatOffer);
+            switch (r)
             {
-                OfferFilterResult r = filter(*wheatOffer);
-                switch (r)
-                {
-                case eKeep:
-                    break;
-                case eStop:
-                    return eFilterStop;
-                case eSkip:
-                    continue;
-                }
+            case eKeep:
+                break;
+            case eStop:
+                return eFilterStop;
+            case eSkip:
+                continue;
             }
+        }
 
-            int64_t numWheatReceived;
-            int64_t numSheepSend;
-
-            CrossOfferResult cor =
-                crossOffer(*wheatOffer, maxWheatReceive, numWheatReceived,
-                           maxSheepSend, numSheepSend);
+        int64_t numWheatReceived;
+        int64_t numSheepSend;
 
-            assert(numSheepSend >= 0);
-            assert(numSheepSend <= maxSheepSend);
-            assert(numWheatReceived >= 0);
-            assert(numWheatReceived <= maxWheatReceive);
+        CrossOfferResult cor =
+            crossOffer(*wheatOffer, maxWheatReceive, numWheatReceived,
+                       maxSheepSend, numSheepSend);
 
-            switch (cor)
-            {
-            case eOfferTaken:
-                assert(offerOffset > 0);
-                offerOffset--; // adjust offset as an offer was deleted
-                break;
-            case eOfferPartial:
-                break;
-            case eOfferCantConvert:
-                return ePartial;
-            }
+        assert(numSheepSend >= 0);
+        assert(numSheepSend <= maxSheepSend);
+        assert(numWheatReceived >= 0);
+        assert(numWheatReceived <= maxWheatReceive);
 
-            sheepSend += numSheepSend;
-            maxSheepSend -= numSheepSend;
+        if (cor == eOfferCantConvert)
+        {
+            return ePartial;
+        }
 
-            wheatReceived += numWheatReceived;
-            maxWheatReceive -= numWheatReceived;
+        sheepSend += numSheepSend;
+        maxSheepSend -= numSheepSend;
 
-            needMore = (maxWheatReceive > 0 && maxSheepSend > 0);
-            if (!needMore)
-            {
-                return eOK;
-            }
-            else if (cor == eOfferPartial)
-            {
-                return ePartial;
-            }
-        }
+        wheatReceived += numWheatReceived;
+        maxWheatReceive -= numWheatReceived;
 
-        // still stuff to fill but no more offers
-        if (needMore && retList.size() < 5)
+        needMore = (maxWheatReceive > 0 && maxSheepSend > 0);
+        if (!needMore)
         {
             return eOK;
         }
+        else if (cor == eOfferPartial)
+        {
+            return ePartial;
+        }
     }
     return eOK;
 }
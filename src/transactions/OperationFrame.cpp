@@ -132,6 +132,25 @@ OperationFrame::getSourceID() const
                                     : mParentTx.getEnvelope().tx.sourceAccount;
 }
 
+void
+OperationFrame::insertLedgerKeysToPrefetch(
+    std::set<LedgerKey, LedgerEntryIdCmp>& keys) const
+{
+    keys.emplace(accountKey(getSourceID()));
+}
+
+void
+OperationFrame::insertAssetKeysToPrefetch(
+    std::set<LedgerKey, LedgerEntryIdCmp>& keys, AccountID const& accountID,
+    Asset const& asset)
+{
+    if (asset.type() != ASSET_TYPE_NATIVE)
+    {
+        keys.emplace(trustLineKey(accountID, asset));
+        keys.emplace(accountKey(getIssuer(asset)));
+    }
+}
+
 bool
 OperationFrame::loadAccount(int ledgerProtocolVersion, LedgerDelta* delta,
                             Database& db)
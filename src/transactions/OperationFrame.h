@@ -46,6 +46,12 @@ class OperationFrame
                          LedgerManager& ledgerManager) = 0;
     virtual ThresholdLevel getThresholdLevel() const;
 
+    // adds the keys of `accountID`'s trust line for `asset` and of the
+    // issuer's account, if `asset` is not native
+    static void
+    insertAssetKeysToPrefetch(std::set<LedgerKey, LedgerEntryIdCmp>& keys,
+                              AccountID const& accountID, Asset const& asset);
+
   public:
     static std::shared_ptr<OperationFrame>
     makeHelper(Operation const& op, OperationResult& res,
@@ -90,6 +96,12 @@ class OperationFrame
     bool apply(SignatureChecker& signatureChecker, LedgerDelta& delta,
                Application& app);
 
+    // Adds the keys of the ledger entries that applying this operation is
+    // known to load, whatever the ledger state, so that they can be
+    // prefetched. By default, only the source account's.
+    virtual void insertLedgerKeysToPrefetch(
+        std::set<LedgerKey, LedgerEntryIdCmp>& keys) const;
+
     Operation const&
     getOperation() const
     {
@@ -352,6 +352,24 @@ PathPaymentOpFrame::doApply(Application& app, LedgerDelta& delta,
     return true;
 }
 
+void
+PathPaymentOpFrame::insertLedgerKeysToPrefetch(
+    std::set<LedgerKey, LedgerEntryIdCmp>& keys) const
+{
+    OperationFrame::insertLedgerKeysToPrefetch(keys);
+    keys.emplace(accountKey(mPathPayment.destination));
+    insertAssetKeysToPrefetch(keys, getSourceID(), mPathPayment.sendAsset);
+    insertAssetKeysToPrefetch(keys, mPathPayment.destination,
+                              mPathPayment.destAsset);
+    for (auto const& asset : mPathPayment.path)
+    {
+        if (asset.type() != ASSET_TYPE_NATIVE)
+        {
+            keys.emplace(accountKey(getIssuer(asset)));
+        }
+    }
+}
+
 bool
 PathPaymentOpFrame::doCheckValid(Application& app)
 {
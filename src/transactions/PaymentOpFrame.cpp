@@ -148,6 +148,16 @@ PaymentOpFrame::doApply(Application& app, LedgerDelta& delta,
     return true;
 }
 
+void
+PaymentOpFrame::insertLedgerKeysToPrefetch(
+    std::set<LedgerKey, LedgerEntryIdCmp>& keys) const
+{
+    OperationFrame::insertLedgerKeysToPrefetch(keys);
+    keys.emplace(accountKey(mPayment.destination));
+    insertAssetKeysToPrefetch(keys, getSourceID(), mPayment.asset);
+    insertAssetKeysToPrefetch(keys, mPayment.destination, mPayment.asset);
+}
+
 bool
 PaymentOpFrame::doCheckValid(Application& app)
 {
@@ -26,6 +26,9 @@ class PaymentOpFrame : public OperationFrame
                  LedgerManager& ledgerManager) override;
     bool doCheckValid(Application& app) override;
 
+    void insertLedgerKeysToPrefetch(
+        std::set<LedgerKey, LedgerEntryIdCmp>& keys) const override;
+
     static PaymentResultCode
     getInnerCode(OperationResult const& res)
     {
@@ -11,12 +11,25 @@
 #include "transactions/SignatureUtils.h"
 #include "util/Algoritm.h"
 
+#include <algorithm>
+#include <bitset>
+#include <cassert>
+
 namespace stellar
 {
 
 using xdr::operator<;
 using xdr::operator==;
 
+// Enough for the 20 signers of an account and its master key.
+static size_t const kMaxSigners = 64;
+
+static uint256 const&
+signerKeyBytes(SignerKey const& key)
+{
+    return key.type() == SIGNER_KEY_TYPE_HASH_X ? key.hashX() : key.ed25519();
+}
+
 SignatureChecker::SignatureChecker(
     uint32_t protocolVersion, Hash const& contentsHash,
     xdr::xvector<DecoratedSignature, 20> const& signatures)
@@ -59,26 +72,51 @@ SignatureChecker::checkSignature(AccountID const& accountID,
         }
     }
 
+    // A signature can only be from a signer whose key ends with its hint, so
+    // signers are indexed by hint, in their order within each hint, and each
+    // signature is only verified against the unused signers with its hint.
+    // The first of them it verifies with is used, as when trying them all.
     using VerifyT =
         std::function<bool(DecoratedSignature const&, Signer const&)>;
-    auto verifyAll = [&](std::vector<Signer>& signers, VerifyT verify) {
+    using HintIndexT = std::vector<std::pair<SignatureHint, size_t>>;
+    auto byHint = [](HintIndexT::value_type const& x,
+                     HintIndexT::value_type const& y) {
+        return x.first < y.first;
+    };
+    auto verifyAll = [&](std::vector<Signer> const& signers, VerifyT verify) {
+        assert(signers.size() <= kMaxSigners);
+        HintIndexT index;
+        index.reserve(signers.size());
+        for (size_t j = 0; j < signers.size(); j++)
+        {
+            index.emplace_back(
+                SignatureUtils::getHint(signerKeyBytes(signers[j].key)), j);
+        }
+        std::stable_sort(index.begin(), index.end(), byHint);
+
+        std::bitset<kMaxSigners> usedSigners;
         for (size_t i = 0; i < mSignatures.size(); i++)
         {
             auto const& sig = mSignatures[i];
+            auto candidates =
+                std::equal_range(index.begin(), index.end(),
+                                 HintIndexT::value_type(sig.hint, 0), byHint);
 
-            for (auto it = signers.begin(); it != signers.end(); ++it)
+            for (auto it = candidates.first; it != candidates.second; ++it)
             {
-                auto& signerKey = *it;
-                if (verify(sig, signerKey))
+                auto const& signerKey = signers[it->second];
+                if (usedSigners.test(it->second) || !verify(sig, signerKey))
                 {
-                    mUsedSignatures[i] = true;
-                    totalWeight += signerKey.weight;
-                    if (totalWeight >= neededWeight)
-                        return true;
-
-                    signers.erase(it);
-                    break;
+                    continue;
                 }
+
+                mUsedSignatures[i] = true;
+                totalWeight += signerKey.weight;
+                if (totalWeight >= neededWeight)
+                    return true;
+
+                usedSigners.set(it->second);
+                break;
             }
         }
 
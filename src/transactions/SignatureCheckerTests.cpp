@@ -0,0 +1,123 @@
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "transactions/SignatureChecker.h"
+#include "crypto/SHA.h"
+#include "crypto/SecretKey.h"
+#include "crypto/SignerKey.h"
+#include "crypto/SignerKeyUtils.h"
+#include "lib/catch.hpp"
+#include "transactions/SignatureUtils.h"
+#include "util/Logging.h"
+
+using namespace stellar;
+
+static std::vector<SecretKey>
+makeKeys(size_t n)
+{
+    std::vector<SecretKey> keys;
+    for (size_t i = 0; i < n; i++)
+    {
+        keys.emplace_back(SecretKey::fromSeed(
+            sha256(std::string{"SIGNER_"} + std::to_string(i))));
+    }
+    return keys;
+}
+
+static Signer
+makeSigner(SecretKey const& key, uint32_t weight)
+{
+    return Signer(KeyUtils::convertKey<SignerKey>(key.getPublicKey()), weight);
+}
+
+TEST_CASE("signature checker", "[signature]")
+{
+    uint32_t const protocolVersion = 9;
+    auto hash = sha256(std::string{"TRANSACTION"});
+    auto keys = makeKeys(20);
+    AccountID accountID = keys[0].getPublicKey();
+
+    std::vector<Signer> signers;
+    for (auto const& key : keys)
+    {
+        signers.emplace_back(makeSigner(key, 1));
+    }
+    auto x = std::string{"PREIMAGE"};
+    signers.emplace_back(SignerKeyUtils::hashXKey(x), 1);
+
+    xdr::xvector<DecoratedSignature, 20> signatures;
+
+    SECTION("signatures in any order")
+    {
+        signatures.emplace_back(SignatureUtils::sign(keys[7], hash));
+        signatures.emplace_back(SignatureUtils::signHashX(x));
+        signatures.emplace_back(SignatureUtils::sign(keys[3], hash));
+        SignatureChecker checker{protocolVersion, hash, signatures};
+        REQUIRE(checker.checkSignature(accountID, signers, 3));
+        REQUIRE(checker.checkAllSignaturesUsed());
+    }
+
+    SECTION("signer used once")
+    {
+        signatures.emplace_back(SignatureUtils::sign(keys[3], hash));
+        signatures.emplace_back(SignatureUtils::sign(keys[3], hash));
+        SignatureChecker checker{protocolVersion, hash, signatures};
+        REQUIRE(!checker.checkSignature(accountID, signers, 2));
+        REQUIRE(!checker.checkAllSignaturesUsed());
+    }
+
+    SECTION("signature from another key")
+    {
+        auto other = SecretKey::fromSeed(sha256(std::string{"OTHER"}));
+        signatures.emplace_back(SignatureUtils::sign(keys[3], hash));
+        signatures.emplace_back(SignatureUtils::sign(other, hash));
+        SignatureChecker checker{protocolVersion, hash, signatures};
+        REQUIRE(checker.checkSignature(accountID, signers, 1));
+        REQUIRE(!checker.checkAllSignaturesUsed());
+    }
+
+    SECTION("signers sharing a hint")
+    {
+        // a key ending like keys[5], tried first but not the signing key
+        auto lookalike = makeSigner(keys[5], 1);
+        lookalike.key.ed25519()[0] ^= 1;
+        signers.insert(signers.begin(), lookalike);
+
+        signatures.emplace_back(SignatureUtils::sign(keys[5], hash));
+        SignatureChecker checker{protocolVersion, hash, signatures};
+        REQUIRE(checker.checkSignature(accountID, signers, 1));
+        REQUIRE(checker.checkAllSignaturesUsed());
+    }
+}
+
+TEST_CASE("signature checker benchmarking", "[signature][bench][hide]")
+{
+    uint32_t const protocolVersion = 9;
+    size_t const n = 100000;
+    auto hash = sha256(std::string{"TRANSACTION"});
+    auto keys = makeKeys(20);
+    AccountID accountID = keys[0].getPublicKey();
+
+    std::vector<Signer> signers;
+    xdr::xvector<DecoratedSignature, 20> signatures;
+    for (auto const& key : keys)
+    {
+        signers.emplace_back(makeSigner(key, 1));
+    }
+    // signatures in the opposite order, the worst case when trying each
+    // signature against every signer
+    for (auto it = keys.rbegin(); it != keys.rend(); ++it)
+    {
+        signatures.emplace_back(SignatureUtils::sign(*it, hash));
+    }
+
+    LOG(INFO) << "Benchmarking " << n << " checks of " << signatures.size()
+              << " signatures against " << signers.size() << " signers";
+    TIMED_SCOPE(timerBlkObj, "checking");
+    for (size_t i = 0; i < n; i++)
+    {
+        SignatureChecker checker{protocolVersion, hash, signatures};
+        REQUIRE(checker.checkSignature(accountID, signers, 20));
+    }
+}
@@ -42,6 +42,16 @@ TransactionFrame::makeTransactionFromWire(Hash const& networkID,
     return res;
 }
 
+TransactionFramePtr
+TransactionFrame::makeTransactionFromWire(Hash const& networkID,
+                                          TransactionEnvelope const& msg,
+                                          ByteSlice const& msgBytes)
+{
+    TransactionFramePtr res = make_shared<TransactionFrame>(networkID, msg);
+    res->mEnvelopeBytes.assign(msgBytes.begin(), msgBytes.end());
+    return res;
+}
+
 TransactionFrame::TransactionFrame(Hash const& networkID,
                                    TransactionEnvelope const& envelope)
     : mEnvelope(envelope), mNetworkID(networkID)
@@ -53,7 +63,7 @@ TransactionFrame::getFullHash() const
 {
     if (isZero(mFullHash))
     {
-        mFullHash = sha256(xdr::xdr_to_opaque(mEnvelope));
+        mFullHash = sha256(getEnvelopeBytes());
     }
     return (mFullHash);
 }
@@ -63,18 +73,41 @@ TransactionFrame::getContentsHash() const
 {
     if (isZero(mContentsHash))
     {
-        mContentsHash = sha256(
-            xdr::xdr_to_opaque(mNetworkID, ENVELOPE_TYPE_TX, mEnvelope.tx));
+        if (mEnvelopeBytes.empty())
+        {
+            mContentsHash = sha256(xdr::xdr_to_opaque(
+                mNetworkID, ENVELOPE_TYPE_TX, mEnvelope.tx));
+        }
+        else
+        {
+            // the transaction is the start of its envelope
+            auto hasher = SHA256::create();
+            hasher->add(xdr::xdr_to_opaque(mNetworkID, ENVELOPE_TYPE_TX));
+            hasher->add(ByteSlice(mEnvelopeBytes.data(),
+                                  xdr::xdr_size(mEnvelope.tx)));
+            mContentsHash = hasher->finish();
+        }
     }
     return (mContentsHash);
 }
 
+xdr::opaque_vec<> const&
+TransactionFrame::getEnvelopeBytes() const
+{
+    if (mEnvelopeBytes.empty())
+    {
+        mEnvelopeBytes = xdr::xdr_to_opaque(mEnvelope);
+    }
+    return mEnvelopeBytes;
+}
+
 void
 TransactionFrame::clearCached()
 {
     Hash zero;
     mContentsHash = zero;
     mFullHash = zero;
+    mEnvelopeBytes.clear();
 }
 
 TransactionResultPair
@@ -134,6 +167,7 @@ TransactionFrame::addSignature(SecretKey const& secretKey)
 void
 TransactionFrame::addSignature(DecoratedSignature const& signature)
 {
+    clearCached();
     mEnvelope.signatures.push_back(signature);
 }
 
@@ -352,6 +386,23 @@ TransactionFrame::processFeeSeqNum(LedgerDelta& delta,
     mSigningAccount->storeChange(delta, db);
 }
 
+void
+TransactionFrame::insertLedgerKeysToPrefetch(
+    std::set<LedgerKey, LedgerEntryIdCmp>& keys) const
+{
+    keys.emplace(accountKey(getSourceID()));
+
+    // operation frames bound to scratch results, so that ours are left as
+    // they are; the frames only read the operations and this transaction
+    OperationResult scratch;
+    auto& self = const_cast<TransactionFrame&>(*this);
+    for (auto const& op : mEnvelope.tx.operations)
+    {
+        OperationFrame::makeHelper(op, scratch, self)
+            ->insertLedgerKeysToPrefetch(keys);
+    }
+}
+
 void
 TransactionFrame::resetSigningAccount()
 {
@@ -455,6 +506,15 @@ TransactionFrame::checkValid(Application& app, SequenceNumber current)
     return res;
 }
 
+bool
+TransactionFrame::loadValidState(Application& app)
+{
+    resetSigningAccount();
+    resetResults();
+    return loadAccount(app.getLedgerManager().getCurrentLedgerVersion(),
+                       nullptr, app.getDatabase());
+}
+
 void
 TransactionFrame::markResultFailed()
 {
@@ -569,13 +629,11 @@ TransactionFrame::storeTransaction(LedgerManager& ledgerManager,
                                    TransactionMeta& tm, int txindex,
                                    TransactionResultSet& resultSet) const
 {
-    auto txBytes(xdr::xdr_to_opaque(mEnvelope));
-
     resultSet.results.emplace_back(getResultPair());
     auto txResultBytes(xdr::xdr_to_opaque(resultSet.results.back()));
 
     std::string txBody;
-    txBody = bn::encode_b64(txBytes);
+    txBody = bn::encode_b64(getEnvelopeBytes());
 
     std::string txResult;
     txResult = bn::encode_b64(txResultBytes);
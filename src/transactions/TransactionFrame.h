@@ -4,6 +4,7 @@
 // under the Apache License, Version 2.0. See the COPYING file at the root
 // of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
 
+#include "crypto/ByteSlice.h"
 #include "ledger/AccountFrame.h"
 #include "ledger/LedgerManager.h"
 #include "overlay/StellarXDR.h"
@@ -46,6 +47,7 @@ class TransactionFrame
     Hash const& mNetworkID;     // used to change the way we compute signatures
     mutable Hash mContentsHash; // the hash of the contents
     mutable Hash mFullHash;     // the hash of the contents and the sig.
+    mutable xdr::opaque_vec<> mEnvelopeBytes; // the XDR of the envelope
 
     std::vector<std::shared_ptr<OperationFrame>> mOperations;
 
@@ -77,9 +79,17 @@ class TransactionFrame
     static TransactionFramePtr
     makeTransactionFromWire(Hash const& networkID,
                             TransactionEnvelope const& msg);
+    // `msgBytes` is the XDR `msg` was decoded from, kept so that the
+    // transaction is hashed and stored without serializing it again.
+    static TransactionFramePtr
+    makeTransactionFromWire(Hash const& networkID,
+                            TransactionEnvelope const& msg,
+                            ByteSlice const& msgBytes);
 
     Hash const& getFullHash() const;
     Hash const& getContentsHash() const;
+    // the XDR of the envelope, as received or serialized once
+    xdr::opaque_vec<> const& getEnvelopeBytes() const;
 
     std::vector<std::shared_ptr<OperationFrame>> const&
     getOperations() const
@@ -142,9 +152,21 @@ class TransactionFrame
 
     bool checkValid(Application& app, SequenceNumber current);
 
+    // Leaves the results and source account as a successful checkValid
+    // would, for a transaction already known to be valid against the last
+    // closed ledger (see ValidationCache). Returns false if the source
+    // account can't be loaded.
+    bool loadValidState(Application& app);
+
     // collect fee, consume sequence number
     void processFeeSeqNum(LedgerDelta& delta, LedgerManager& ledgerManager);
 
+    // adds the keys of the ledger entries that processing the fee and
+    // applying the operations are known to load, see
+    // OperationFrame::insertLedgerKeysToPrefetch
+    void insertLedgerKeysToPrefetch(
+        std::set<LedgerKey, LedgerEntryIdCmp>& keys) const;
+
     // apply this transaction to the current ledger
     // returns true if successfully applied
     bool apply(LedgerDelta& delta, TransactionMeta& meta, Application& app);
@@ -23,6 +23,7 @@
 #include "util/Logging.h"
 #include "util/Timer.h"
 #include "util/make_unique.h"
+#include "xdrpp/marshal.h"
 
 using namespace stellar;
 using namespace stellar::txtest;
@@ -1029,3 +1030,29 @@ TEST_CASE("txenvelope", "[tx][envelope]")
         }
     }
 }
+
+TEST_CASE("transaction from wire bytes", "[tx][envelope]")
+{
+    Config const& cfg = getTestConfig();
+    VirtualClock clock;
+    auto app = createTestApplication(clock, cfg);
+    app->start();
+
+    auto root = TestAccount::createRoot(*app);
+    auto tx = root.tx({payment(root, 10)});
+    auto bytes = xdr::xdr_to_opaque(tx->getEnvelope());
+
+    auto fromWire = TransactionFrame::makeTransactionFromWire(
+        app->getNetworkID(), tx->getEnvelope(), bytes);
+    REQUIRE(fromWire->getEnvelopeBytes() == bytes);
+    REQUIRE(fromWire->getFullHash() == tx->getFullHash());
+    REQUIRE(fromWire->getContentsHash() == tx->getContentsHash());
+
+    // signing again forgets the bytes received
+    auto a1 = root.create("A", app->getLedgerManager().getMinBalance(0));
+    fromWire->addSignature(a1);
+    REQUIRE(fromWire->getEnvelopeBytes() ==
+            xdr::xdr_to_opaque(fromWire->getEnvelope()));
+    REQUIRE(fromWire->getFullHash() != tx->getFullHash());
+    REQUIRE(fromWire->getContentsHash() == tx->getContentsHash());
+}
@@ -0,0 +1,61 @@
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/BloomFilter.h"
+#include <cassert>
+
+namespace stellar
+{
+
+uint32_t const BloomFilter::kBitsPerItem = 10;
+
+// ln(2) * kBitsPerItem, rounded: the optimal probe count for that density.
+static uint32_t const kNumHashes = 7;
+
+BloomFilter::BloomFilter(size_t expectedItems)
+    : mBits((expectedItems * kBitsPerItem + 63) / 64 + 1, 0)
+    , mNumHashes(kNumHashes)
+{
+}
+
+BloomFilter::BloomFilter(uint32_t numHashes, xdr::xvector<uint64_t> bits)
+    : mBits(std::move(bits)), mNumHashes(numHashes)
+{
+}
+
+void
+BloomFilter::add(uint64_t hash)
+{
+    assert(!mBits.empty());
+    uint64_t nBits = mBits.size() * 64;
+    uint32_t h1 = static_cast<uint32_t>(hash);
+    uint32_t h2 = static_cast<uint32_t>(hash >> 32);
+    for (uint32_t i = 0; i < mNumHashes; ++i)
+    {
+        uint64_t bit = (h1 + static_cast<uint64_t>(i) * h2) % nBits;
+        mBits[bit / 64] |= (uint64_t(1) << (bit % 64));
+    }
+}
+
+bool
+BloomFilter::mayContain(uint64_t hash) const
+{
+    if (mBits.empty())
+    {
+        return false;
+    }
+    uint64_t nBits = mBits.size() * 64;
+    uint32_t h1 = static_cast<uint32_t>(hash);
+    uint32_t h2 = static_cast<uint32_t>(hash >> 32);
+    for (uint32_t i = 0; i < mNumHashes; ++i)
+    {
+        uint64_t bit = (h1 + static_cast<uint64_t>(i) * h2) % nBits;
+        if ((mBits[bit / 64] & (uint64_t(1) << (bit % 64))) == 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "xdrpp/types.h"
+#include <cstdint>
+
+namespace stellar
+{
+
+/**
+ * A plain bloom filter over 64-bit hashes of the items it holds. The k probe
+ * positions are derived from the single hash by double hashing, so callers
+ * hash each item once and can test that hash against many filters.
+ *
+ * The filter is sized up front for a given number of items; adding more than
+ * that only raises the false-positive rate.
+ */
+class BloomFilter
+{
+    xdr::xvector<uint64_t> mBits;
+    uint32_t mNumHashes{0};
+
+  public:
+    // Bits of filter allocated per item; with the matching number of probes
+    // this gives a false-positive rate a little under 1%.
+    static uint32_t const kBitsPerItem;
+
+    // An empty filter, which contains nothing.
+    BloomFilter() = default;
+
+    // A filter sized for `expectedItems` items.
+    explicit BloomFilter(size_t expectedItems);
+
+    // A filter reconstituted from previously-saved state.
+    BloomFilter(uint32_t numHashes, xdr::xvector<uint64_t> bits);
+
+    void add(uint64_t hash);
+
+    // Returns false if the item with `hash` was definitely never added.
+    bool mayContain(uint64_t hash) const;
+
+    uint32_t
+    getNumHashes() const
+    {
+        return mNumHashes;
+    }
+
+    xdr::xvector<uint64_t> const&
+    getBits() const
+    {
+        return mBits;
+    }
+};
+}
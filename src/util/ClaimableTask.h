@@ -0,0 +1,53 @@
+#pragma once
+
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/NonCopyable.h"
+#include <atomic>
+#include <functional>
+#include <future>
+
+namespace stellar
+{
+
+/**
+ * A piece of work posted to the worker threads that whoever needs its result
+ * can claim: the first of a worker and the waiting thread to get to it runs
+ * it, the other one does not. A thread waiting for the result thus never
+ * sits behind unrelated work (bucket merges, for instance) queued on the
+ * worker threads ahead of it.
+ */
+class ClaimableTask : NonMovableOrCopyable
+{
+    std::atomic<bool> mClaimed{false};
+    std::packaged_task<void()> mTask;
+    std::shared_future<void> mDone;
+
+  public:
+    explicit ClaimableTask(std::function<void()> fn) : mTask(std::move(fn))
+    {
+        mDone = mTask.get_future().share();
+    }
+
+    // runs the task, unless another thread started it already
+    void
+    run()
+    {
+        if (!mClaimed.exchange(true))
+        {
+            mTask();
+        }
+    }
+
+    // runs the task if no other thread started it yet, or waits for the one
+    // that did; rethrows what the task threw
+    void
+    wait()
+    {
+        run();
+        mDone.get();
+    }
+};
+}
@@ -135,6 +135,13 @@ class VirtualClock
 
     VirtualClock(Mode mode = VIRTUAL_TIME);
     ~VirtualClock();
+
+    Mode
+    getMode() const
+    {
+        return mMode;
+    }
+
     size_t crank(bool block = true);
     void noteCrankOccurred(bool hadIdle);
     uint32_t recentIdleCrankPercent() const;
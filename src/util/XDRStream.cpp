@@ -0,0 +1,135 @@
+// Copyright 2018 Stellar Development Foundation and contributors. Licensed
+// under the Apache License, Version 2.0. See the COPYING file at the root
+// of this distribution or at http://www.apache.org/licenses/LICENSE-2.0
+
+#include "util/XDRStream.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace stellar
+{
+
+static void
+throwOpenFailure(std::string const& filename)
+{
+    std::string msg("failed to map XDR file: ");
+    msg += filename;
+    msg += ", reason: ";
+    msg += std::to_string(errno);
+    CLOG(ERROR, "Fs") << msg;
+    throw std::runtime_error(msg);
+}
+
+XDRInputMappedFileStream::~XDRInputMappedFileStream()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+void
+XDRInputMappedFileStream::open(std::string const& filename)
+{
+    close();
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                              nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN,
+                              nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        throwOpenFailure(filename);
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        throwOpenFailure(filename);
+    }
+    mSize = static_cast<size_t>(size.QuadPart);
+    mPos = 0;
+    if (mSize != 0)
+    {
+        HANDLE mapping =
+            CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void* p = nullptr;
+        if (mapping != nullptr)
+        {
+            p = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+        }
+        if (p == nullptr)
+        {
+            CloseHandle(file);
+            throwOpenFailure(filename);
+        }
+        mData = static_cast<unsigned char const*>(p);
+    }
+    CloseHandle(file);
+}
+
+void
+XDRInputMappedFileStream::close()
+{
+    if (mData != nullptr)
+    {
+        UnmapViewOfFile(mData);
+    }
+    mData = nullptr;
+    mSize = 0;
+    mPos = 0;
+}
+
+#else
+
+void
+XDRInputMappedFileStream::open(std::string const& filename)
+{
+    close();
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throwOpenFailure(filename);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        throwOpenFailure(filename);
+    }
+    mSize = static_cast<size_t>(st.st_size);
+    mPos = 0;
+    if (mSize != 0)
+    {
+        void* p = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED)
+        {
+            ::close(fd);
+            throwOpenFailure(filename);
+        }
+        madvise(p, mSize, MADV_SEQUENTIAL);
+        mData = static_cast<unsigned char const*>(p);
+    }
+    // The mapping keeps the file alive; the descriptor is no longer needed.
+    ::close(fd);
+}
+
+void
+XDRInputMappedFileStream::close()
+{
+    if (mData != nullptr)
+    {
+        munmap(const_cast<unsigned char*>(mData), mSize);
+    }
+    mData = nullptr;
+    mSize = 0;
+    mPos = 0;
+}
+
+#endif
+}
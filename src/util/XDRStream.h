@@ -7,6 +7,7 @@
 #include "crypto/ByteSlice.h"
 #include "crypto/SHA.h"
 #include "util/Logging.h"
+#include "util/NonCopyable.h"
 #include "xdrpp/marshal.h"
 #include <fstream>
 #include <string>
@@ -15,6 +16,35 @@
 namespace stellar
 {
 
+/**
+ * Serialize `t` into the start of `buf` as a single record of the framed format
+ * read by XDRInputFileStream and written by XDROutputFileStream, growing `buf`
+ * if necessary. Returns the size of the framed record.
+ */
+template <typename T>
+uint32_t
+xdrFrameRecord(T const& t, std::vector<char>& buf)
+{
+    uint32_t sz = (uint32_t)xdr::xdr_size(t);
+    assert(sz < 0x80000000);
+
+    if (buf.size() < sz + 4)
+    {
+        buf.resize(sz + 4);
+    }
+
+    // Write 4 bytes of size, big-endian, with XDR 'continuation' bit set on
+    // high bit of high byte.
+    buf[0] = static_cast<char>((sz >> 24) & 0xFF) | '\x80';
+    buf[1] = static_cast<char>((sz >> 16) & 0xFF);
+    buf[2] = static_cast<char>((sz >> 8) & 0xFF);
+    buf[3] = static_cast<char>(sz & 0xFF);
+
+    xdr::xdr_put p(buf.data() + 4, buf.data() + 4 + sz);
+    xdr_argpack_archive(p, t);
+    return sz + 4;
+}
+
 /**
  * Helper for loading a sequence of XDR objects from a file one at a time,
  * rather than all at once.
@@ -56,6 +86,22 @@ class XDRInputFileStream
         return mIn.good();
     }
 
+    // Offset in the file of the next record readOne will read.
+    size_t
+    pos()
+    {
+        return static_cast<size_t>(mIn.tellg());
+    }
+
+    // Position the stream so that the next readOne reads the record starting
+    // at `offset`, clearing any EOF or failure state left by a previous read.
+    void
+    seek(size_t offset)
+    {
+        mIn.clear();
+        mIn.seekg(offset);
+    }
+
     template <typename T>
     bool
     readOne(T& out)
@@ -95,6 +141,75 @@ class XDRInputFileStream
     }
 };
 
+/**
+ * Like XDRInputFileStream, but reads from a read-only memory mapping of the
+ * whole file and decodes each record directly out of the mapped pages, with
+ * no per-record read call or copy through an intermediate buffer. The mapping
+ * is advised for sequential access, so the kernel reads ahead aggressively.
+ */
+class XDRInputMappedFileStream : NonMovableOrCopyable
+{
+    unsigned char const* mData{nullptr};
+    size_t mSize{0};
+    size_t mPos{0};
+
+  public:
+    ~XDRInputMappedFileStream();
+
+    void close();
+
+    void open(std::string const& filename);
+
+    operator bool() const
+    {
+        return mData != nullptr && mPos < mSize;
+    }
+
+    size_t
+    pos() const
+    {
+        return mPos;
+    }
+
+    void
+    seek(size_t offset)
+    {
+        mPos = offset;
+    }
+
+    template <typename T>
+    bool
+    readOne(T& out)
+    {
+        if (mData == nullptr || mPos > mSize || mSize - mPos < 4)
+        {
+            return false;
+        }
+
+        // Same framing as XDRInputFileStream::readOne. Every record is a
+        // multiple of 4 bytes long, so the record body is suitably aligned
+        // for xdr_get.
+        unsigned char const* p = mData + mPos;
+        uint32_t sz = 0;
+        sz |= static_cast<uint8_t>(p[0] & 0x7f);
+        sz <<= 8;
+        sz |= p[1];
+        sz <<= 8;
+        sz |= p[2];
+        sz <<= 8;
+        sz |= p[3];
+
+        if (sz > mSize - mPos - 4)
+        {
+            throw xdr::xdr_runtime_error("malformed XDR file");
+        }
+        xdr::xdr_get g(p + 4, p + 4 + sz);
+        xdr::xdr_argpack_archive(g, out);
+        mPos += sz + 4;
+        return true;
+    }
+};
+
 class XDROutputFileStream
 {
     std::ofstream mOut;
@@ -131,35 +246,18 @@ class XDROutputFileStream
     bool
     writeOne(T const& t, SHA256* hasher = nullptr, size_t* bytesPut = nullptr)
     {
-        uint32_t sz = (uint32_t)xdr::xdr_size(t);
-        assert(sz < 0x80000000);
-
-        if (mBuf.size() < sz + 4)
-        {
-            mBuf.resize(sz + 4);
-        }
-
-        // Write 4 bytes of size, big-endian, with XDR 'continuation' bit set on
-        // high bit of high byte.
-        mBuf[0] = static_cast<char>((sz >> 24) & 0xFF) | '\x80';
-        mBuf[1] = static_cast<char>((sz >> 16) & 0xFF);
-        mBuf[2] = static_cast<char>((sz >> 8) & 0xFF);
-        mBuf[3] = static_cast<char>(sz & 0xFF);
-
-        xdr::xdr_put p(mBuf.data() + 4, mBuf.data() + 4 + sz);
-        xdr_argpack_archive(p, t);
-
-        if (!mOut.write(mBuf.data(), sz + 4))
+        uint32_t sz = xdrFrameRecord(t, mBuf);
+        if (!mOut.write(mBuf.data(), sz))
         {
             return false;
         }
         if (hasher)
         {
-            hasher->add(ByteSlice(mBuf.data(), sz + 4));
+            hasher->add(ByteSlice(mBuf.data(), sz));
         }
         if (bytesPut)
         {
-            *bytesPut += (sz + 4);
+            *bytesPut += sz;
         }
         return true;
     }